@@ -23,6 +23,7 @@
 
 #include "include/debug.hpp"
 #include "include/rustic.hpp"   // slice and option
+#include "include/rc_string.hpp"
 #include "include/compile_error.hpp"
 
 template<typename T>
@@ -131,6 +132,16 @@ static inline Ordering ord(const ::std::string& l, const ::std::string& r)
     else
         return OrdLess;
 }
+static inline Ordering ord(const RcString& l, const RcString& r)
+{
+    int v = l.compare(r);
+    if(v == 0)
+        return OrdEqual;
+    else if( v > 0 )
+        return OrdGreater;
+    else
+        return OrdLess;
+}
 template<typename T>
 Ordering ord(const T& l, const T& r)
 {
@@ -182,6 +193,12 @@ Ordering ord(const ::std::map<T,U>& l, const ::std::map<T,U>& r)
 }
 #define ORD(a,b)    do { Ordering ORD_rv = ::ord(a,b); if( ORD_rv != ::OrdEqual )   return ORD_rv; } while(0)
 
+/// Mix `v` into the hash `h` (for the `hash()` methods on compiler types, which must agree with `ord`)
+static inline size_t hash_combine(size_t h, size_t v)
+{
+    return h ^ (v + static_cast<size_t>(0x9e3779b97f4a7c15ull) + (h << 6) + (h >> 2));
+}
+
 
 template <typename T>
 struct LList
@@ -0,0 +1,266 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * compile_server.cpp
+ * - Persistent compile server (`mrustc --compile-server`)
+ *
+ * Used by build tools (minicargo) to avoid re-loading the same extern crates for every crate in a build.
+ *
+ * Protocol (stdin): Each job is a sequence of NUL-terminated strings
+ *   <id> <cwd> <logfile> <arg>... "" <NAME=value>... ""
+ * (i.e. the argument and environment lists are each terminated by an empty string)
+ * Protocol (stdout): One line per completed job, `<id> <exit status>`
+ *
+ * Each job runs in a forked child (with stdout redirected to the log file), so jobs see a pristine copy of the
+ * server's state. Extern crates loaded by a job are reported back to the server, which then loads them itself
+ * so later jobs get them for free.
+ */
+#include <main_bindings.hpp>
+#include <hir/main_bindings.hpp>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#ifndef _WIN32
+# include <unistd.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+#endif
+
+#ifdef _WIN32
+
+int CompileServer_Run(const char* argv0, int (*compile)(int argc, char *argv[]))
+{
+    // TODO: Needs a replacement for fork() (e.g. a persistent worker process that is re-used)
+    ::std::cerr << "--compile-server is not supported on this platform" << ::std::endl;
+    return 1;
+}
+
+#else
+
+namespace {
+    struct Job
+    {
+        ::std::string   id;
+        ::std::string   cwd;
+        ::std::string   logfile;
+        ::std::vector< ::std::string>   args;
+        ::std::vector< ::std::string>   env;
+    };
+    struct RunningJob
+    {
+        ::std::string   id;
+        pid_t   pid;
+        int report_fd;
+        ::std::string   report;
+    };
+
+    bool write_all(int fd, const ::std::string& data)
+    {
+        size_t  ofs = 0;
+        while( ofs < data.size() )
+        {
+            auto rv = write(fd, data.data() + ofs, data.size() - ofs);
+            if( rv < 0 )
+                return false;
+            ofs += rv;
+        }
+        return true;
+    }
+
+    /// Attempt to parse a complete job from the start of `buf` (consuming it if successful)
+    bool parse_job(::std::string& buf, Job& out_job)
+    {
+        size_t  pos = 0;
+        auto get = [&](::std::string& out)->bool {
+            auto end = buf.find('\0', pos);
+            if( end == ::std::string::npos )
+                return false;
+            out = buf.substr(pos, end - pos);
+            pos = end + 1;
+            return true;
+            };
+        Job rv;
+        if( !get(rv.id) || !get(rv.cwd) || !get(rv.logfile) )
+            return false;
+        for(;;)
+        {
+            ::std::string   v;
+            if( !get(v) )
+                return false;
+            if( v == "" )
+                break;
+            rv.args.push_back(v);
+        }
+        for(;;)
+        {
+            ::std::string   v;
+            if( !get(v) )
+                return false;
+            if( v == "" )
+                break;
+            rv.env.push_back(v);
+        }
+        buf.erase(0, pos);
+        out_job = ::std::move(rv);
+        return true;
+    }
+
+    /// Body of the forked child, never returns
+    void run_job_child(const char* argv0, int (*compile)(int argc, char *argv[]), const Job& job, int report_fd)
+    {
+        int null_fd = open("/dev/null", O_RDONLY);
+        dup2(null_fd, 0);
+        close(null_fd);
+
+        if( job.cwd != "" && chdir(job.cwd.c_str()) != 0 ) {
+            perror("chdir");
+            _exit(1);
+        }
+        int log_fd = open(job.logfile.c_str(), O_CREAT|O_WRONLY|O_TRUNC, 0644);
+        if( log_fd < 0 ) {
+            perror("open log");
+            _exit(1);
+        }
+        dup2(log_fd, 1);
+        close(log_fd);
+
+        for(const auto& e : job.env)
+        {
+            putenv(const_cast<char*>(e.c_str()));
+        }
+
+        ::std::vector<char*>    argv;
+        argv.push_back(const_cast<char*>(argv0));
+        for(const auto& a : job.args)
+            argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+
+        int rv = compile(static_cast<int>(argv.size() - 1), argv.data());
+
+        ::std::string   report;
+        for(const auto& f : HIR_Deserialise_TakeLoadedFiles())
+        {
+            report += f;
+            report += '\n';
+        }
+        write_all(report_fd, report);
+        close(report_fd);
+        exit(rv);
+    }
+}
+
+int CompileServer_Run(const char* argv0, int (*compile)(int argc, char *argv[]))
+{
+    // Results go to the original stdout, anything else printed (e.g. debug output) goes to stderr
+    int result_fd = dup(1);
+    dup2(2, 1);
+
+    ::std::vector<RunningJob>   running;
+    ::std::string   input_buf;
+    bool input_open = true;
+
+    while( input_open || !running.empty() )
+    {
+        ::std::vector<struct pollfd>    fds;
+        if( input_open )
+            fds.push_back({ 0, POLLIN, 0 });
+        for(const auto& j : running)
+            fds.push_back({ j.report_fd, POLLIN, 0 });
+        if( poll(fds.data(), fds.size(), -1) < 0 )
+        {
+            if( errno == EINTR )
+                continue ;
+            perror("poll");
+            return 1;
+        }
+
+        size_t fd_idx = 0;
+        if( input_open )
+        {
+            if( fds[fd_idx].revents != 0 )
+            {
+                char    buf[4096];
+                auto len = read(0, buf, sizeof(buf));
+                if( len <= 0 )
+                    input_open = false;
+                else
+                    input_buf.append(buf, len);
+            }
+            fd_idx ++;
+        }
+
+        // Check for completed jobs (EOF on the report pipe)
+        for(size_t i = 0; i < running.size(); )
+        {
+            if( fds[fd_idx++].revents == 0 ) {
+                i ++;
+                continue ;
+            }
+            auto& j = running[i];
+            char    buf[4096];
+            auto len = read(j.report_fd, buf, sizeof(buf));
+            if( len > 0 ) {
+                j.report.append(buf, len);
+                i ++;
+                continue ;
+            }
+
+            close(j.report_fd);
+            int status = 0;
+            waitpid(j.pid, &status, 0);
+            int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+            if( !write_all(result_fd, j.id + " " + ::std::to_string(exit_code) + "\n") )
+                input_open = false;
+
+            // Load the crates that the job had to read itself, so later jobs can use them
+            // - Only for successful jobs, a failed job may have loaded a broken file.
+            if( exit_code == 0 )
+            {
+                size_t  start = 0;
+                for(;;)
+                {
+                    auto end = j.report.find('\n', start);
+                    if( end == ::std::string::npos )
+                        break;
+                    HIR_Deserialise_Preload(j.report.substr(start, end - start));
+                    start = end + 1;
+                }
+            }
+            running.erase(running.begin() + i);
+        }
+
+        // Start any newly received jobs
+        Job job;
+        while( parse_job(input_buf, job) )
+        {
+            int report_pipe[2];
+            if( pipe(report_pipe) != 0 ) {
+                perror("pipe");
+                return 1;
+            }
+            pid_t pid = fork();
+            if( pid < 0 ) {
+                perror("fork");
+                return 1;
+            }
+            if( pid == 0 )
+            {
+                close(report_pipe[0]);
+                close(result_fd);
+                for(const auto& j : running)
+                    close(j.report_fd);
+                run_job_child(argv0, compile, job, report_pipe[1]);
+            }
+            close(report_pipe[1]);
+            running.push_back(RunningJob { job.id, pid, report_pipe[0], "" });
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -1,46 +1,31 @@
-
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * debug.cpp
+ * - Debug output (out-of-line parts of `TraceLog`)
+ */
 #include <debug.hpp>
 
-TraceLog::TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb, ::std::function<void(::std::ostream&)> ret):
-    m_tag(tag),
-    m_ret(ret)
-{
-    if(debug_enabled()) {
-        auto& os = debug_output(g_debug_indent_level, m_tag);
-        os << ">> (";
-        info_cb(os);
-        os << ")" << ::std::endl;
-    }
-    INDENT();
-}
-TraceLog::TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb):
-    m_tag(tag),
-    m_ret([](const auto&){})
+void TraceLog::enter(const char* tag, const TraceFmtRef* info_cb)
 {
-    if(debug_enabled()) {
-        auto& os = debug_output(g_debug_indent_level, m_tag);
+    m_tag = tag;
+    auto& os = debug_output(g_debug_indent_level, m_tag);
+    if( info_cb ) {
         os << ">> (";
-        info_cb(os);
+        (*info_cb)(os);
         os << ")" << ::std::endl;
     }
-    INDENT();
-}
-TraceLog::TraceLog(const char* tag):
-    m_tag(tag),
-    m_ret([](const auto&){})
-{
-    if(debug_enabled()) {
-        auto& os = debug_output(g_debug_indent_level, m_tag);
+    else {
         os << ">>" << ::std::endl;
     }
     INDENT();
 }
-TraceLog::~TraceLog() {
+void TraceLog::leave()
+{
     UNINDENT();
-    if(debug_enabled()) {
-        auto& os = debug_output(g_debug_indent_level, m_tag);
-        os << "<< (";
-        m_ret(os);
-        os << ")" << ::std::endl;
-    }
+    auto& os = debug_output(g_debug_indent_level, m_tag);
+    os << "<< (";
+    m_ret(os);
+    os << ")" << ::std::endl;
 }
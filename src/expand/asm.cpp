@@ -17,7 +17,7 @@
 
 namespace
 {
-    ::std::string get_string(const Span& sp, TokenStream& lex, const ::AST::Crate& crate, AST::Module& mod)
+    ::std::string get_string(const Span& sp, TokenStream& lex, ::AST::Crate& crate, AST::Module& mod)
     {
         auto n = Parse_ExprVal(lex);
         ASSERT_BUG(sp, n, "No expression returned");
@@ -35,7 +35,7 @@ namespace
 class CAsmExpander:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const ::AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, ::AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         Token   tok;
         auto lex = TTStream(sp, tt);
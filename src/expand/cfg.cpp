@@ -91,7 +91,7 @@ bool check_cfg(Span sp, const ::AST::MetaItem& mi) {
 class CCfgExpander:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const ::AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, ::AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" ) {
             ERROR(sp, E0000, "cfg! doesn't take an identifier");
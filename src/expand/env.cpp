@@ -13,7 +13,7 @@
 
 namespace {
     // Read a string out of the input stream
-    ::std::string get_string(const Span& sp, const AST::Crate& crate, AST::Module& mod, const TokenTree& tt) {
+    ::std::string get_string(const Span& sp, AST::Crate& crate, AST::Module& mod, const TokenTree& tt) {
         auto lex = TTStream(sp, tt);
 
         auto n = Parse_ExprVal(lex);
@@ -34,7 +34,7 @@ namespace {
 class CExpanderEnv:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" )
             ERROR(sp, E0000, "env! doesn't take an ident");
@@ -51,7 +51,7 @@ class CExpanderEnv:
 class CExpanderOptionEnv:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" )
             ERROR(sp, E0000, "option_env! doesn't take an ident");
@@ -12,10 +12,12 @@
 #include <parse/ttstream.hpp>
 #include <parse/lex.hpp>    // Lexer (new files)
 #include <ast/expr.hpp>
+#include <ast/crate.hpp>    // for m_extra_files
+#include <fstream>
 
 namespace {
 
-    ::std::string get_string(const Span& sp, TokenStream& lex, const ::AST::Crate& crate, AST::Module& mod)
+    ::std::string get_string(const Span& sp, TokenStream& lex, ::AST::Crate& crate, AST::Module& mod)
     {
         auto n = Parse_ExprVal(lex);
         ASSERT_BUG(sp, n, "No expression returned");
@@ -63,7 +65,7 @@ namespace {
 class CIncludeExpander:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" )
             ERROR(sp, E0000, "include! doesn't take an ident");
@@ -75,6 +77,7 @@ class CIncludeExpander:
         GET_CHECK_TOK(tok, lex, TOK_EOF);
 
         ::std::string file_path = get_path_relative_to(mod.m_file_info.path, mv$(path));
+        crate.m_extra_files.push_back(file_path);
 
         try {
             return box$( Lexer(file_path) );
@@ -89,7 +92,7 @@ class CIncludeExpander:
 class CIncludeBytesExpander:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" )
             ERROR(sp, E0000, "include_bytes! doesn't take an ident");
@@ -101,6 +104,7 @@ class CIncludeBytesExpander:
         GET_CHECK_TOK(tok, lex, TOK_EOF);
 
         ::std::string file_path = get_path_relative_to(mod.m_file_info.path, mv$(path));
+        crate.m_extra_files.push_back(file_path);
 
         ::std::ifstream is(file_path);
         if( !is.good() ) {
@@ -118,7 +122,7 @@ class CIncludeBytesExpander:
 class CIncludeStrExpander:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" )
             ERROR(sp, E0000, "include_str! doesn't take an ident");
@@ -130,6 +134,7 @@ class CIncludeStrExpander:
         GET_CHECK_TOK(tok, lex, TOK_EOF);
 
         ::std::string file_path = get_path_relative_to(mod.m_file_info.path, mv$(path));
+        crate.m_extra_files.push_back(file_path);
 
         ::std::ifstream is(file_path);
         if( !is.good() ) {
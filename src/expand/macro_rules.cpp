@@ -22,7 +22,7 @@
 class CMacroRulesExpander:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const ::AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, ::AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident == "" )
             ERROR(sp, E0000, "macro_rules! requires an identifier" );
@@ -62,8 +62,10 @@ class CMacroUseHandler:
                     });
                 for(const auto& p : ec.m_hir->m_proc_macros)
                 {
-                    mod.m_macro_imports.push_back(::std::make_pair( p.path.m_components, nullptr ));
-                    mod.m_macro_imports.back().first.insert( mod.m_macro_imports.back().first.begin(), p.path.m_crate_name );
+                    ::std::vector< ::std::string>   path;
+                    path.push_back( p.path.m_crate_name );
+                    path.insert( path.end(), p.path.m_components.begin(), p.path.m_components.end() );
+                    mod.m_macro_imports.push_back(::std::make_pair( mv$(path), nullptr ));
                 }
             }
         )
@@ -13,7 +13,7 @@
 class CExpanderRegisterDiagnostic:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         return box$( TTStreamO(sp, TokenTree()) );
     }
@@ -21,7 +21,7 @@ class CExpanderRegisterDiagnostic:
 class CExpanderDiagnosticUsed:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         return box$( TTStreamO(sp, TokenTree()) );
     }
@@ -29,7 +29,7 @@ class CExpanderDiagnosticUsed:
 class CExpanderBuildDiagnosticArray:
     public ExpandProcMacro
 {
-    ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
+    ::std::unique_ptr<TokenStream> expand(const Span& sp, AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
         if( ident != "" )
             ERROR(sp, E0000, "__build_diagnostic_array! doesn't take an ident");
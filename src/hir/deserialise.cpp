@@ -13,6 +13,14 @@
 #include <macro_rules/macro_rules.hpp>
 #include "serialise_lowlevel.hpp"
 #include <typeinfo>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+# include <direct.h>    // _getcwd
+# define getcwd _getcwd
+#else
+# include <unistd.h>    // getcwd
+#endif
 
 namespace {
 
@@ -23,7 +31,7 @@ namespace {
 
     class HirDeserialiser
     {
-        ::std::string m_crate_name;
+        RcString m_crate_name;
         ::HIR::serialise::Reader&   m_in;
     public:
         HirDeserialiser(::HIR::serialise::Reader& in):
@@ -31,6 +39,7 @@ namespace {
         {}
 
         ::std::string read_string() { return m_in.read_string(); }
+        RcString read_istring() { return m_in.read_istring(); }
         bool read_bool() { return m_in.read_bool(); }
         size_t deserialise_count() { return m_in.read_count(); }
 
@@ -328,7 +337,22 @@ namespace {
             ::HIR::ExprPtr  rv;
             if( m_in.read_bool() )
             {
-                rv.m_mir = deserialise_mir();
+                if( m_in.version() >= 1 )
+                {
+                    // Only deserialised when first used (most extern MIR never is)
+                    auto blob = m_in.read_blob( m_in.read_u64c() );
+                    auto crate_name = m_crate_name;
+                    rv.m_mir = ::MIR::FunctionPointer::new_lazy([blob,crate_name]() {
+                        ::HIR::serialise::Reader    in { blob };
+                        HirDeserialiser s { in };
+                        s.m_crate_name = crate_name;
+                        return s.deserialise_mir().release();
+                        });
+                }
+                else
+                {
+                    rv.m_mir = deserialise_mir();
+                }
             }
             rv.m_erased_types = deserialise_vec< ::HIR::TypeRef>();
             return rv;
@@ -671,6 +695,9 @@ namespace {
     DEF_D( ::std::string,
         return d.read_string(); );
     template<>
+    DEF_D( RcString,
+        return d.read_istring(); );
+    template<>
     DEF_D( bool,
         return d.read_bool(); );
 
@@ -785,8 +812,8 @@ namespace {
     {
         TRACE_FUNCTION;
         // HACK! If the read crate name is empty, replace it with the name we're loaded with
-        auto crate_name = m_in.read_string();
-        auto components = deserialise_vec< ::std::string>();
+        auto crate_name = m_in.read_istring();
+        auto components = deserialise_vec<RcString>();
         if( crate_name == "" && components.size() > 0)
         {
             assert(!m_crate_name.empty());
@@ -1229,9 +1256,38 @@ namespace {
     }
 }
 
-::HIR::CratePtr HIR_Deserialise(const ::std::string& filename, const ::std::string& loaded_name)
-{
-    try
+namespace {
+    /// Crates loaded ahead of time by `HIR_Deserialise_Preload` (keyed on absolute path)
+    struct PreloadedCrate
+    {
+        time_t  mtime;
+        off_t   size;
+        ::HIR::CratePtr crate;
+    };
+    ::std::map< ::std::string, PreloadedCrate>  g_preloaded_crates;
+    /// Files that `HIR_Deserialise` had to read from disk
+    ::std::vector< ::std::string>   g_loaded_files;
+
+    ::std::string get_absolute_path(const ::std::string& filename)
+    {
+        if( filename.empty() || filename[0] == '/' || filename[0] == '\\' || (filename.size() > 1 && filename[1] == ':') )
+            return filename;
+        char    buf[4096];
+        if( !getcwd(buf, sizeof(buf)) )
+            return filename;
+        return ::std::string(buf) + "/" + filename;
+    }
+    bool get_file_stamp(const ::std::string& filename, time_t& out_mtime, off_t& out_size)
+    {
+        struct stat s;
+        if( stat(filename.c_str(), &s) != 0 )
+            return false;
+        out_mtime = s.st_mtime;
+        out_size = s.st_size;
+        return true;
+    }
+
+    ::HIR::CratePtr deserialise_file(const ::std::string& filename)
     {
         ::HIR::serialise::Reader    in{ filename };
         HirDeserialiser  s { in };
@@ -1240,6 +1296,55 @@ namespace {
 
         return ::HIR::CratePtr( mv$(rv) );
     }
+}
+
+void HIR_Deserialise_Preload(const ::std::string& filename)
+{
+    auto path = get_absolute_path(filename);
+    time_t  mtime;
+    off_t   size;
+    if( !get_file_stamp(path, mtime, size) )
+        return ;
+    auto it = g_preloaded_crates.find(path);
+    if( it != g_preloaded_crates.end() && it->second.mtime == mtime && it->second.size == size )
+        return ;
+    try
+    {
+        g_preloaded_crates[path] = PreloadedCrate { mtime, size, deserialise_file(path) };
+    }
+    catch(const ::std::runtime_error& )
+    {
+        // Not fatal, the compile that needs this will load it itself (and report the error)
+        g_preloaded_crates.erase(path);
+    }
+}
+::std::vector< ::std::string> HIR_Deserialise_TakeLoadedFiles()
+{
+    return mv$(g_loaded_files);
+}
+
+::HIR::CratePtr HIR_Deserialise(const ::std::string& filename, const ::std::string& loaded_name)
+{
+    try
+    {
+        if( !g_preloaded_crates.empty() )
+        {
+            auto path = get_absolute_path(filename);
+            auto it = g_preloaded_crates.find(path);
+            time_t  mtime;
+            off_t   size;
+            if( it != g_preloaded_crates.end() && get_file_stamp(path, mtime, size) && it->second.mtime == mtime && it->second.size == size )
+            {
+                DEBUG("Using preloaded " << path);
+                auto rv = mv$(it->second.crate);
+                g_preloaded_crates.erase(it);
+                return rv;
+            }
+        }
+        g_loaded_files.push_back( get_absolute_path(filename) );
+
+        return deserialise_file(filename);
+    }
     catch(int)
     { ::std::abort(); }
     catch(const ::std::runtime_error& e)
@@ -1257,3 +1362,9 @@ namespace {
     #endif
 }
 
+
+::MIR::FunctionPointer HIR_DeserialiseMir(::HIR::serialise::Reader& in)
+{
+    HirDeserialiser  s { in };
+    return s.deserialise_mir();
+}
@@ -9,6 +9,8 @@
  */
 #include "hir.hpp"
 #include <algorithm>
+#include <mutex>
+#include <unordered_map>
 #include <hir_typeck/common.hpp>
 
 namespace HIR {
@@ -1219,15 +1221,188 @@ const ::HIR::Function& ::HIR::Crate::get_function_by_path(const Span& sp, const
     }
 }
 
+namespace {
+    /// Head constructor of a type (used to bucket trait impls)
+    struct TypeHeadKey
+    {
+        unsigned int    tag;
+        unsigned int    sub;    // Primitive type, borrow/pointer type, tuple size, or path tag
+        ::HIR::SimplePath   path;
+
+        bool operator==(const TypeHeadKey& x) const {
+            return tag == x.tag && sub == x.sub && path == x.path;
+        }
+    };
+    size_t hash_simplepath(const ::HIR::SimplePath& p)
+    {
+        size_t  h = p.m_crate_name.hash();
+        for(const auto& c : p.m_components)
+            h = h * 31 + c.hash();
+        return h;
+    }
+    struct TypeHeadKeyHash {
+        size_t operator()(const TypeHeadKey& k) const {
+            return (k.tag * 131 + k.sub) ^ hash_simplepath(k.path);
+        }
+    };
+    struct SimplePathHash {
+        size_t operator()(const ::HIR::SimplePath& p) const {
+            return hash_simplepath(p);
+        }
+    };
+
+    TypeHeadKey make_head_key(const ::HIR::TypeRef& ty)
+    {
+        TypeHeadKey rv { static_cast<unsigned int>(ty.m_data.tag()), 0, {} };
+        TU_MATCH_DEF(::HIR::TypeRef::Data, (ty.m_data), (e),
+        (
+            ),
+        (Primitive,
+            rv.sub = static_cast<unsigned int>(e);
+            ),
+        (Path,
+            rv.sub = static_cast<unsigned int>(e.path.m_data.tag());
+            if( const auto* pe = e.path.m_data.opt_Generic() )
+                rv.path = pe->m_path;
+            ),
+        (Tuple,
+            rv.sub = static_cast<unsigned int>(e.size());
+            ),
+        (Borrow,
+            rv.sub = static_cast<unsigned int>(e.type);
+            ),
+        (Pointer,
+            rv.sub = static_cast<unsigned int>(e.type);
+            )
+        )
+        return rv;
+    }
+    /// Get the bucket key for an impl's type (returns false if the impl could match any type)
+    /// - Mirrors the rules in `matches_type_int`
+    bool get_impl_type_key(const ::HIR::TypeRef& ty, TypeHeadKey& out_key)
+    {
+        if( ty.m_data.is_Generic() || ty.m_data.is_Infer() )
+            return false;
+        // Only generic paths are compared by `matches_type_int`, anything else is left in the fallback list
+        if( ty.m_data.is_Path() && !ty.m_data.as_Path().path.m_data.is_Generic() )
+            return false;
+        out_key = make_head_key(ty);
+        return true;
+    }
+    /// Get the bucket key for a queried type (returns false if all impls have to be checked)
+    bool get_query_type_key(const ::HIR::TypeRef& ty, TypeHeadKey& out_key)
+    {
+        // Unknown types (and unbound paths) fuzzy-match anything
+        if( ty.m_data.is_Infer() )
+            return false;
+        if( TU_TEST1(ty.m_data, Path, .binding.is_Unbound()) )
+            return false;
+        // NOTE: Generics and non-generic paths produce keys that are never used by impls, so only the fallback list
+        // is checked for them.
+        out_key = make_head_key(ty);
+        return true;
+    }
+}
+
+namespace HIR {
+struct TraitImplIndex
+{
+    struct Entry {
+        unsigned int    seq;    // Index within the `equal_range` for the trait, used to keep the original order
+        const ::HIR::TraitImpl* impl;
+    };
+    struct Trait {
+        ::std::unordered_map<TypeHeadKey, ::std::vector<Entry>, TypeHeadKeyHash>   by_type;
+        // Impls that could match any type (e.g. `impl<T> Trait for T`)
+        ::std::vector<Entry>    fallback;
+    };
+
+    size_t  impl_count;
+    ::std::unordered_map< ::HIR::SimplePath, Trait, SimplePathHash>   traits;
+
+    TraitImplIndex(const ::std::multimap< ::HIR::SimplePath, ::HIR::TraitImpl >& impls):
+        impl_count(impls.size())
+    {
+        Trait*  cur_trait = nullptr;
+        const ::HIR::SimplePath*    cur_path = nullptr;
+        unsigned int    seq = 0;
+        for(const auto& e : impls)
+        {
+            if( !cur_path || *cur_path != e.first ) {
+                cur_path = &e.first;
+                cur_trait = &traits[e.first];
+                seq = 0;
+            }
+            TypeHeadKey key;
+            if( get_impl_type_key(e.second.m_type, key) )
+                cur_trait->by_type[mv$(key)].push_back(Entry { seq, &e.second });
+            else
+                cur_trait->fallback.push_back(Entry { seq, &e.second });
+            seq ++;
+        }
+    }
+};
+}
+
+namespace {
+    ::std::mutex    g_trait_impl_index_lock;
+}
+
 bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const
 {
-    auto its = this->m_trait_impls.equal_range( trait );
-    for( auto it = its.first; it != its.second; ++ it )
+    const auto& type_r = (type.m_data.is_Infer() || type.m_data.is_Generic() ? ty_res(type) : type);
+    TypeHeadKey key;
+    if( !get_query_type_key(type_r, key) )
     {
-        const auto& impl = it->second;
-        if( impl.matches_type(type, ty_res) ) {
-            if( callback(impl) ) {
-                return true;
+        auto its = this->m_trait_impls.equal_range( trait );
+        for( auto it = its.first; it != its.second; ++ it )
+        {
+            const auto& impl = it->second;
+            if( impl.matches_type(type, ty_res) ) {
+                if( callback(impl) ) {
+                    return true;
+                }
+            }
+        }
+    }
+    else
+    {
+        // Get the index (building it if this is the first lookup, or if impls have been added since)
+        auto index = ::std::atomic_load(&m_trait_impl_index);
+        if( !index || index->impl_count != m_trait_impls.size() )
+        {
+            ::std::lock_guard<::std::mutex> lh { g_trait_impl_index_lock };
+            index = ::std::atomic_load(&m_trait_impl_index);
+            if( !index || index->impl_count != m_trait_impls.size() )
+            {
+                index = ::std::make_shared<const TraitImplIndex>(m_trait_impls);
+                ::std::atomic_store(&m_trait_impl_index, index);
+            }
+        }
+
+        auto trait_it = index->traits.find(trait);
+        if( trait_it != index->traits.end() )
+        {
+            static const ::std::vector<TraitImplIndex::Entry>   empty;
+            const auto& fallback = trait_it->second.fallback;
+            auto bucket_it = trait_it->second.by_type.find(key);
+            const auto& bucket = (bucket_it != trait_it->second.by_type.end() ? bucket_it->second : empty);
+
+            // Merge the two lists (both sorted by `seq`) so impls are visited in the same order as a full search
+            auto it_b = bucket.begin();
+            auto it_f = fallback.begin();
+            while( it_b != bucket.end() || it_f != fallback.end() )
+            {
+                const ::HIR::TraitImpl* impl;
+                if( it_f == fallback.end() || (it_b != bucket.end() && it_b->seq < it_f->seq) )
+                    impl = (it_b++)->impl;
+                else
+                    impl = (it_f++)->impl;
+                if( impl->matches_type(type, ty_res) ) {
+                    if( callback(*impl) ) {
+                        return true;
+                    }
+                }
             }
         }
     }
@@ -1239,6 +1414,10 @@ bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR:
     }
     return false;
 }
+void ::HIR::Crate::invalidate_trait_impl_index()
+{
+    ::std::atomic_store(&m_trait_impl_index, ::std::shared_ptr<const TraitImplIndex>());
+}
 bool ::HIR::Crate::find_auto_trait_impls(const ::HIR::SimplePath& trait, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::MarkerImpl&)> callback) const
 {
     auto its = this->m_marker_impls.equal_range( trait );
@@ -466,6 +466,9 @@ public:
     // A list of attributes to hand to the handler
     ::std::vector<::std::string>    attributes;
 };
+/// Index of `Crate::m_trait_impls` by trait and the head of the impl type (see `Crate::find_trait_impls`)
+struct TraitImplIndex;
+
 class Crate
 {
 public:
@@ -478,6 +481,8 @@ public:
     /// Impl blocks
     ::std::multimap< ::HIR::SimplePath, ::HIR::TraitImpl > m_trait_impls;
     ::std::multimap< ::HIR::SimplePath, ::HIR::MarkerImpl > m_marker_impls;
+    /// Lookup index for `m_trait_impls`, built on first use (rebuilt if impls are added, see `invalidate_trait_impl_index` for type changes)
+    mutable ::std::shared_ptr<const TraitImplIndex>  m_trait_impl_index;
 
     /// Macros exported by this crate
     ::std::unordered_map< ::std::string, ::MacroRulesPtr >  m_exported_macros;
@@ -530,6 +535,9 @@ public:
     }
 
     bool find_trait_impls(const ::HIR::SimplePath& path, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const;
+    /// Discard the `find_trait_impls` index, which is keyed on the head of each impl's type.
+    /// - Must be called when the type of an impl in `m_trait_impls` is changed (`HIR::Visitor` does this itself)
+    void invalidate_trait_impl_index();
     bool find_auto_trait_impls(const ::HIR::SimplePath& path, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::MarkerImpl&)> callback) const;
     bool find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback) const;
 };
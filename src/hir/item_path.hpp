@@ -20,6 +20,8 @@ public:
     const char* crate_name = nullptr;
 
     ItemPath(const ::std::string& crate): crate_name(crate.c_str()) {}
+    ItemPath(const RcString& crate): crate_name(crate.c_str()) {}
+    ItemPath(const char* crate): crate_name(crate) {}
     ItemPath(const ItemPath& p, const char* n):
         parent(&p),
         name(n)
@@ -8,14 +8,28 @@
 #pragma once
 
 #include "crate_ptr.hpp"
+#include "serialise_lowlevel.hpp"   // serialise::Compression
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace AST {
     class Crate;
 }
+namespace MIR {
+    class Function;
+    class FunctionPointer;
+}
 
 extern void HIR_Dump(::std::ostream& sink, const ::HIR::Crate& crate);
 extern ::HIR::CratePtr  LowerHIR_FromAST(::AST::Crate crate);
-extern void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate);
+extern void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate, ::HIR::serialise::Compression compression=::HIR::serialise::Compression::ZlibBest);
 extern ::HIR::CratePtr HIR_Deserialise(const ::std::string& filename, const ::std::string& loaded_name);
+/// Load a crate ahead of time, a later `HIR_Deserialise` of the same (unmodified) file takes it instead of reading the file
+extern void HIR_Deserialise_Preload(const ::std::string& filename);
+/// Get (and clear) the list of files that `HIR_Deserialise` has read from disk
+extern ::std::vector< ::std::string> HIR_Deserialise_TakeLoadedFiles();
+/// Write a single MIR body (outside of a crate, e.g. for the monomorphisation cache)
+extern void HIR_SerialiseMir(::HIR::serialise::Writer& out, const ::MIR::Function& fcn);
+/// Read a MIR body written by `HIR_SerialiseMir` (all paths in it must have a crate name)
+extern ::MIR::FunctionPointer HIR_DeserialiseMir(::HIR::serialise::Reader& in);
@@ -8,7 +8,7 @@
 #include <hir/path.hpp>
 #include <hir/type.hpp>
 
-::HIR::SimplePath HIR::SimplePath::operator+(const ::std::string& s) const
+::HIR::SimplePath HIR::SimplePath::operator+(const RcString& s) const
 {
     ::HIR::SimplePath ret(m_crate_name);
     ret.m_components = m_components;
@@ -405,6 +405,40 @@ Ordering HIR::Path::ord(const ::HIR::Path& x) const
     throw "";
 }
 
+size_t HIR::PathParams::hash() const
+{
+    size_t  h = m_types.size();
+    for(const auto& t : m_types)
+        h = hash_combine(h, t.hash());
+    return h;
+}
+size_t HIR::Path::hash() const
+{
+    size_t  h = static_cast<size_t>(m_data.tag());
+    TU_MATCH(::HIR::Path::Data, (this->m_data), (pe),
+    (Generic,
+        return hash_combine(h, pe.hash());
+        ),
+    (UfcsInherent,
+        h = hash_combine(h, pe.type->hash());
+        h = hash_combine(h, ::std::hash<::std::string>()(pe.item));
+        return hash_combine(h, pe.params.hash());
+        ),
+    (UfcsKnown,
+        h = hash_combine(h, pe.type->hash());
+        h = hash_combine(h, pe.trait.hash());
+        h = hash_combine(h, ::std::hash<::std::string>()(pe.item));
+        return hash_combine(h, pe.params.hash());
+        ),
+    (UfcsUnknown,
+        h = hash_combine(h, pe.type->hash());
+        h = hash_combine(h, ::std::hash<::std::string>()(pe.item));
+        return hash_combine(h, pe.params.hash());
+        )
+    )
+    throw "";
+}
+
 bool ::HIR::Path::operator==(const Path& x) const {
     return this->ord(x) == ::OrdEqual;
 }
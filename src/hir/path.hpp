@@ -54,18 +54,26 @@ static inline Compare& operator &=(Compare& x, const Compare& y) {
 /// Simple path - Absolute with no generic parameters
 struct SimplePath
 {
-    ::std::string   m_crate_name;
-    ::std::vector< ::std::string>   m_components;
+    RcString    m_crate_name;
+    ::std::vector<RcString> m_components;
 
     SimplePath():
         m_crate_name("")
     {
     }
-    SimplePath(::std::string crate):
+    SimplePath(RcString crate):
         m_crate_name( mv$(crate) )
     {
     }
-    SimplePath(::std::string crate, ::std::vector< ::std::string> components):
+    SimplePath(const ::std::string& crate):
+        m_crate_name( crate )
+    {
+    }
+    SimplePath(const char* crate):
+        m_crate_name( crate )
+    {
+    }
+    SimplePath(RcString crate, ::std::vector<RcString> components):
         m_crate_name( mv$(crate) ),
         m_components( mv$(components) )
     {
@@ -73,7 +81,7 @@ struct SimplePath
 
     SimplePath clone() const;
 
-    SimplePath operator+(const ::std::string& s) const;
+    SimplePath operator+(const RcString& s) const;
     bool operator==(const SimplePath& x) const {
         return m_crate_name == x.m_crate_name && m_components == x.m_components;
     }
@@ -91,6 +99,12 @@ struct SimplePath
         rv = ::ord(m_components, x.m_components);
         return rv;
     }
+    size_t hash() const {
+        size_t  h = m_crate_name.hash();
+        for(const auto& c : m_components)
+            h = hash_combine(h, c.hash());
+        return h;
+    }
     friend ::std::ostream& operator<<(::std::ostream& os, const SimplePath& x);
 };
 
@@ -122,6 +136,7 @@ struct PathParams
     Ordering ord(const PathParams& x) const {
         return ::ord(m_types, x.m_types);
     }
+    size_t hash() const;
 
     friend ::std::ostream& operator<<(::std::ostream& os, const PathParams& x);
 };
@@ -149,6 +164,9 @@ public:
         if(rv != OrdEqual)  return rv;
         return ::ord(m_params, x.m_params);
     }
+    size_t hash() const {
+        return hash_combine(m_path.hash(), m_params.hash());
+    }
 
     friend ::std::ostream& operator<<(::std::ostream& os, const GenericPath& x);
 };
@@ -175,6 +193,10 @@ public:
         ORD(m_hrls, x.m_hrls);
         return ::ord(m_type_bounds, x.m_type_bounds);
     }
+    // NOTE: Only hashes the trait path (HRLs and bounds are rarely what distinguishes two trait paths)
+    size_t hash() const {
+        return m_path.hash();
+    }
 
     friend ::std::ostream& operator<<(::std::ostream& os, const TraitPath& x);
 };
@@ -222,6 +244,7 @@ public:
     Compare compare_with_placeholders(const Span& sp, const Path& x, t_cb_resolve_type resolve_placeholder) const;
 
     Ordering ord(const Path& x) const;
+    size_t hash() const;
 
     bool operator==(const Path& x) const;
     bool operator!=(const Path& x) const { return !(*this == x); }
@@ -232,5 +255,22 @@ public:
 
 }   // namespace HIR
 
+namespace std {
+    template<>
+    struct hash< ::HIR::GenericPath>
+    {
+        size_t operator()(const ::HIR::GenericPath& p) const {
+            return p.hash();
+        }
+    };
+    template<>
+    struct hash< ::HIR::Path>
+    {
+        size_t operator()(const ::HIR::Path& p) const {
+            return p.hash();
+        }
+    };
+}
+
 #endif
 
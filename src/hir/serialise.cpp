@@ -387,6 +387,9 @@ namespace {
         void serialise(const ::std::string& v) {
             m_out.write_string(v);
         }
+        void serialise(const RcString& v) {
+            m_out.write_string(v);
+        }
 
         void serialise(const ::MacroRulesPtr& mac)
         {
@@ -486,7 +489,11 @@ namespace {
         {
             m_out.write_bool( (bool)exp.m_mir && save_mir );
             if( exp.m_mir && save_mir ) {
-                serialise(*exp.m_mir);
+                // Written as a length-prefixed blob, so the reader can defer loading it until it's used
+                ::HIR::serialise::Writer    mir_out;
+                HirSerialiser   { mir_out }.serialise(*exp.m_mir);
+                m_out.write_u64c( mir_out.buffer().size() );
+                m_out.write( mir_out.buffer().data(), mir_out.buffer().size() );
             }
             serialise_vec( exp.m_erased_types );
         }
@@ -1007,10 +1014,14 @@ namespace {
     };
 }
 
-void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate)
+void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate, ::HIR::serialise::Compression compression)
 {
-    ::HIR::serialise::Writer    out { filename };
+    ::HIR::serialise::Writer    out { filename, compression };
     HirSerialiser  s { out };
     s.serialise_crate(crate);
 }
-
+void HIR_SerialiseMir(::HIR::serialise::Writer& out, const ::MIR::Function& fcn)
+{
+    HirSerialiser  s { out };
+    s.serialise(fcn);
+}
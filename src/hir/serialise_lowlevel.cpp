@@ -11,26 +11,47 @@
 #include <fstream>
 #include <string.h>   // memcpy
 #include <common.hpp>
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
 
 namespace HIR {
 namespace serialise {
 
+namespace {
+    // File header: magic followed by a format byte
+    // - Files without this header predate it, and are always zlib compressed (which starts with 0x78)
+    const char FILE_MAGIC[4] = { 'M', 'H', 'I', 'R' };
+    enum class Format : uint8_t {
+        Raw = 0,
+        Zlib = 1,
+    };
+}
+
 class WriterInner
 {
     ::std::ofstream m_backing;
+    bool    m_compress;
     z_stream    m_zstream;
     ::std::vector<unsigned char> m_buffer;
 
     unsigned int    m_byte_out_count = 0;
     unsigned int    m_byte_in_count = 0;
 public:
-    WriterInner(const ::std::string& filename);
+    WriterInner(const ::std::string& filename, Compression compression);
     ~WriterInner();
     void write(const void* buf, size_t len);
 };
 
-Writer::Writer(const ::std::string& filename):
-    m_inner( new WriterInner(filename) )
+Writer::Writer(const ::std::string& filename, Compression compression):
+    m_inner( new WriterInner(filename, compression) )
+{
+}
+Writer::Writer():
+    m_inner( nullptr )
 {
 }
 Writer::~Writer()
@@ -39,21 +60,36 @@ Writer::~Writer()
 }
 void Writer::write(const void* buf, size_t len)
 {
-    m_inner->write(buf, len);
+    if( m_inner )
+    {
+        m_inner->write(buf, len);
+    }
+    else
+    {
+        const auto* p = reinterpret_cast<const uint8_t*>(buf);
+        m_mem_buffer.insert(m_mem_buffer.end(), p, p + len);
+    }
 }
 
 
-WriterInner::WriterInner(const ::std::string& filename):
+WriterInner::WriterInner(const ::std::string& filename, Compression compression):
     m_backing( filename, ::std::ios_base::out | ::std::ios_base::binary),
+    m_compress( compression != Compression::None ),
     m_zstream(),
     m_buffer( 16*1024 )
     //m_buffer( 4*1024 )
 {
+    m_backing.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    m_backing.put( static_cast<char>(m_compress ? Format::Zlib : Format::Raw) );
+    m_backing.put( static_cast<char>(CUR_VERSION) );
+    if( !m_compress )
+        return ;
+
     m_zstream.zalloc = Z_NULL;
     m_zstream.zfree = Z_NULL;
     m_zstream.opaque = Z_NULL;
 
-    const int COMPRESSION_LEVEL = Z_BEST_COMPRESSION;
+    const int COMPRESSION_LEVEL = (compression == Compression::ZlibFast ? Z_BEST_SPEED : Z_BEST_COMPRESSION);
     int ret = deflateInit(&m_zstream, COMPRESSION_LEVEL);
     if(ret != Z_OK)
         throw ::std::runtime_error("zlib init failure");
@@ -63,6 +99,8 @@ WriterInner::WriterInner(const ::std::string& filename):
 }
 WriterInner::~WriterInner()
 {
+    if( !m_compress )
+        return ;
     assert( m_zstream.avail_in == 0 );
 
     // Complete the compression
@@ -89,6 +127,14 @@ WriterInner::~WriterInner()
 
 void WriterInner::write(const void* buf, size_t len)
 {
+    if( !m_compress )
+    {
+        m_backing.write( reinterpret_cast<const char*>(buf), len );
+        m_byte_out_count += len;
+        m_byte_in_count += len;
+        return ;
+    }
+
     m_zstream.avail_in = len;
     m_zstream.next_in = reinterpret_cast<unsigned char*>( const_cast<void*>(buf) );
 
@@ -142,15 +188,30 @@ void WriterInner::write(const void* buf, size_t len)
 class ReaderInner
 {
     ::std::ifstream m_backing;
+    bool    m_compressed;
     z_stream    m_zstream;
     ::std::vector<unsigned char> m_buffer;
 
+    // Uncompressed data is read directly from memory (a mapping of the file, or a blob)
+    ::std::shared_ptr<const void>   m_mem_owner;
+    const uint8_t*  m_mem_data = nullptr;
+    size_t  m_mem_size = 0;
+    size_t  m_mem_pos = 0;
+
+    unsigned int    m_version = 0;
     unsigned int    m_byte_out_count = 0;
     unsigned int    m_byte_in_count = 0;
 public:
     ReaderInner(const ::std::string& filename);
+    ReaderInner(const Blob& blob);
     ~ReaderInner();
+
+    unsigned int version() const { return m_version; }
+    bool is_memory() const { return !m_compressed; }
     size_t read(void* buf, size_t len);
+    Blob read_blob(size_t len);
+private:
+    void map_file(const ::std::string& filename, size_t offset);
 };
 
 
@@ -189,13 +250,41 @@ Reader::Reader(const ::std::string& filename):
     m_buffer(1024)
 {
 }
+Reader::Reader(const Blob& blob):
+    m_inner( new ReaderInner(blob) ),
+    m_buffer(0)
+{
+}
 Reader::~Reader()
 {
     delete m_inner, m_inner = nullptr;
 }
+unsigned int Reader::version() const
+{
+    return m_inner->version();
+}
+
+Blob Reader::read_blob(size_t len)
+{
+    if( m_inner->is_memory() )
+    {
+        return m_inner->read_blob(len);
+    }
+    auto buf = ::std::make_shared< ::std::vector<uint8_t> >(len);
+    this->read(buf->data(), len);
+    return Blob { buf, buf->data(), len };
+}
 
 void Reader::read(void* buf, size_t len)
 {
+    // In-memory data doesn't need the intermediate buffer
+    if( m_inner->is_memory() )
+    {
+        if( m_inner->read(buf, len) != len )
+            throw ::std::runtime_error( FMT("Reader::read - Requested " << len << " bytes, hit end of data") );
+        return ;
+    }
+
     auto used = m_buffer.read(buf, len);
     if( used == len ) {
         return ;
@@ -219,12 +308,40 @@ void Reader::read(void* buf, size_t len)
 
 ReaderInner::ReaderInner(const ::std::string& filename):
     m_backing(filename, ::std::ios_base::in|::std::ios_base::binary),
+    m_compressed(true),
     m_zstream(),
     m_buffer(16*1024)
 {
     if( !m_backing.is_open() )
         throw ::std::runtime_error("Unable to open file");
 
+    char header[sizeof(FILE_MAGIC)+2];
+    m_backing.read(header, sizeof(header));
+    if( m_backing.gcount() == sizeof(header) && memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 )
+    {
+        m_version = static_cast<uint8_t>(header[sizeof(FILE_MAGIC)+1]);
+        if( m_version > CUR_VERSION )
+            throw ::std::runtime_error(FMT("Metadata version " << m_version << " is newer than supported (" << CUR_VERSION << ")"));
+        switch( static_cast<Format>(header[sizeof(FILE_MAGIC)]) )
+        {
+        case Format::Raw:
+            m_compressed = false;
+            m_backing.close();
+            map_file(filename, sizeof(header));
+            return ;
+        case Format::Zlib:
+            break;
+        default:
+            throw ::std::runtime_error("Unknown metadata format");
+        }
+    }
+    else
+    {
+        // No header, rewind and treat as zlib
+        m_backing.clear();
+        m_backing.seekg(0);
+    }
+
     m_zstream.zalloc = Z_NULL;
     m_zstream.zfree = Z_NULL;
     m_zstream.opaque = Z_NULL;
@@ -235,12 +352,72 @@ ReaderInner::ReaderInner(const ::std::string& filename):
 
     m_zstream.avail_in = 0;
 }
+ReaderInner::ReaderInner(const Blob& blob):
+    m_compressed(false),
+    m_zstream(),
+    m_mem_owner(blob.owner),
+    m_mem_data(blob.data),
+    m_mem_size(blob.size),
+    m_version(CUR_VERSION)
+{
+}
 ReaderInner::~ReaderInner()
 {
-    inflateEnd(&m_zstream);
+    if( m_compressed )
+        inflateEnd(&m_zstream);
+}
+void ReaderInner::map_file(const ::std::string& filename, size_t offset)
+{
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if( fd < 0 )
+        throw ::std::runtime_error("Unable to open file");
+    struct stat st;
+    if( fstat(fd, &st) != 0 ) {
+        close(fd);
+        throw ::std::runtime_error("Unable to stat file");
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if( base != MAP_FAILED )
+    {
+        m_mem_owner = ::std::shared_ptr<const void>(base, [size](const void* p){ munmap(const_cast<void*>(p), size); });
+        m_mem_data = reinterpret_cast<const uint8_t*>(base);
+        m_mem_size = size;
+        m_mem_pos = offset;
+        return ;
+    }
+#endif
+    // No mapping available, read the whole file into memory instead
+    ::std::ifstream is(filename, ::std::ios_base::in|::std::ios_base::binary);
+    auto buf = ::std::make_shared< ::std::vector<uint8_t> >( ::std::istreambuf_iterator<char>(is), ::std::istreambuf_iterator<char>() );
+    m_mem_data = buf->data();
+    m_mem_size = buf->size();
+    m_mem_pos = offset;
+    m_mem_owner = mv$(buf);
+}
+Blob ReaderInner::read_blob(size_t len)
+{
+    assert( !m_compressed );
+    if( m_mem_size - m_mem_pos < len )
+        throw ::std::runtime_error( FMT("ReaderInner::read_blob - Requested " << len << " bytes, hit end of data") );
+    Blob rv { m_mem_owner, m_mem_data + m_mem_pos, len };
+    m_mem_pos += len;
+    return rv;
 }
 size_t ReaderInner::read(void* buf, size_t len)
 {
+    if( !m_compressed )
+    {
+        size_t rv = ::std::min(len, m_mem_size - m_mem_pos);
+        memcpy(buf, m_mem_data + m_mem_pos, rv);
+        m_mem_pos += rv;
+        m_byte_in_count += rv;
+        m_byte_out_count += rv;
+        return rv;
+    }
+
     m_zstream.avail_out = len;
     m_zstream.next_out = reinterpret_cast<unsigned char*>(buf);
     do {
@@ -9,8 +9,11 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include <stddef.h>
+#include <stdint.h>
 #include <assert.h>
+#include <rc_string.hpp>
 
 namespace HIR {
 namespace serialise {
@@ -18,15 +21,33 @@ namespace serialise {
 class WriterInner;
 class ReaderInner;
 
+/// Compression used for the serialised stream (recorded in the file header, so the reader detects it)
+enum class Compression
+{
+    None,       // Stored uncompressed, fastest to write and load
+    ZlibFast,   // zlib, fastest level
+    ZlibBest,   // zlib, best compression (smallest files)
+};
+
+/// Version of the metadata layout written by `Writer` (files from before the header was added are version 0)
+/// - 1: MIR bodies are stored as length-prefixed blobs, so they can be loaded on first use
+const unsigned int CUR_VERSION = 1;
+
 class Writer
 {
     WriterInner*    m_inner;
+    // Output when writing to memory (`m_inner` is null)
+    ::std::vector<uint8_t>  m_mem_buffer;
 public:
-    Writer(const ::std::string& path);
+    Writer(const ::std::string& path, Compression compression=Compression::ZlibBest);
+    /// Write to an in-memory buffer (see `buffer`)
+    Writer();
     Writer(const Writer&) = delete;
     Writer(Writer&&) = delete;
     ~Writer();
 
+    const ::std::vector<uint8_t>& buffer() const { return m_mem_buffer; }
+
     void write(const void* data, size_t count);
 
     void write_u8(uint8_t v) {
@@ -131,6 +152,14 @@ public:
 };
 
 
+/// Block of serialised data that stays valid after the `Reader` it came from is destroyed
+struct Blob
+{
+    ::std::shared_ptr<const void>   owner;
+    const uint8_t*  data;
+    size_t  size;
+};
+
 class ReadBuffer
 {
     ::std::vector<uint8_t>  m_backing;
@@ -149,11 +178,18 @@ class Reader
     ReadBuffer  m_buffer;
 public:
     Reader(const ::std::string& path);
+    /// Read from a blob previously returned by `read_blob`
+    Reader(const Blob& blob);
     Reader(const Writer&) = delete;
     Reader(Writer&&) = delete;
     ~Reader();
 
+    /// Layout version of the file (see `CUR_VERSION`)
+    unsigned int version() const;
+
     void read(void* dst, size_t count);
+    /// Read `count` bytes for later use (not copied if the file is already in memory)
+    Blob read_blob(size_t count);
 
     uint8_t read_u8() {
         uint8_t v;
@@ -261,6 +297,26 @@ public:
         read( const_cast<char*>(rv.data()), len);
         return rv;
     }
+    /// Read a string and intern it (avoids a temporary allocation for short strings)
+    RcString read_istring() {
+        size_t len = read_u8();
+        if( len < 128 ) {
+        }
+        else {
+            len = (len & 0x7F) << 16;
+            len |= read_u16();
+        }
+        char    buf[128];
+        if( len <= sizeof(buf) ) {
+            read(buf, len);
+            return RcString(buf, len);
+        }
+        else {
+            ::std::string   tmp(len, '\0');
+            read( const_cast<char*>(tmp.data()), len);
+            return RcString(tmp);
+        }
+    }
     bool read_bool() {
         return read_u8() != 0x00;
     }
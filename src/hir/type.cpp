@@ -8,6 +8,7 @@
 #include "type.hpp"
 #include <span.hpp>
 #include "expr.hpp" // Hack for cloning array types
+#include <stats.hpp>
 
 namespace HIR {
 
@@ -380,6 +381,69 @@ Ordering HIR::TypeRef::ord(const ::HIR::TypeRef& x) const
     )
     throw "";
 }
+size_t HIR::TypeRef::hash() const
+{
+    // NOTE: Must only hash fields that `ord` compares
+    size_t  h = static_cast<size_t>(m_data.tag());
+    TU_MATCH(::HIR::TypeRef::Data, (m_data), (te),
+    (Infer,
+        return hash_combine(h, te.index);
+        ),
+    (Diverge,
+        return h;
+        ),
+    (Primitive,
+        return hash_combine(h, static_cast<size_t>(te));
+        ),
+    (Path,
+        return hash_combine(h, te.path.hash());
+        ),
+    (Generic,
+        h = hash_combine(h, ::std::hash<::std::string>()(te.name));
+        return hash_combine(h, te.binding);
+        ),
+    (TraitObject,
+        h = hash_combine(h, te.m_trait.hash());
+        for(const auto& m : te.m_markers)
+            h = hash_combine(h, m.hash());
+        return h;
+        ),
+    (ErasedType,
+        return hash_combine(h, te.m_origin.hash());
+        ),
+    (Array,
+        h = hash_combine(h, te.inner->hash());
+        return hash_combine(h, te.size_val);
+        ),
+    (Slice,
+        return hash_combine(h, te.inner->hash());
+        ),
+    (Tuple,
+        for(const auto& t : te)
+            h = hash_combine(h, t.hash());
+        return h;
+        ),
+    (Borrow,
+        h = hash_combine(h, static_cast<size_t>(te.type));
+        return hash_combine(h, te.inner->hash());
+        ),
+    (Pointer,
+        h = hash_combine(h, static_cast<size_t>(te.type));
+        return hash_combine(h, te.inner->hash());
+        ),
+    (Function,
+        h = hash_combine(h, te.is_unsafe);
+        h = hash_combine(h, ::std::hash<::std::string>()(te.m_abi));
+        for(const auto& t : te.m_arg_types)
+            h = hash_combine(h, t.hash());
+        return hash_combine(h, te.m_rettype->hash());
+        ),
+    (Closure,
+        return hash_combine(h, reinterpret_cast<size_t>(te.node));
+        )
+    )
+    throw "";
+}
 bool ::HIR::TypeRef::contains_generics() const
 {
     struct H {
@@ -793,6 +857,7 @@ bool ::HIR::TypeRef::match_test_generics(const Span& sp, const ::HIR::TypeRef& x
 
 ::HIR::TypeRef HIR::TypeRef::clone() const
 {
+    STATS_COUNT("HIR::TypeRef::clone");
     TU_MATCH(::HIR::TypeRef::Data, (m_data), (e),
     (Infer,
         return ::HIR::TypeRef( Data::make_Infer(e) );
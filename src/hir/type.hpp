@@ -264,6 +264,8 @@ public:
     bool operator!=(const ::HIR::TypeRef& x) const { return !(*this == x); }
     bool operator<(const ::HIR::TypeRef& x) const { return ord(x) == OrdLess; }
     Ordering ord(const ::HIR::TypeRef& x) const;
+    /// Structural hash (equal under `ord` implies equal hashes)
+    size_t hash() const;
 
     bool contains_generics() const;
 
@@ -284,5 +286,15 @@ extern ::std::ostream& operator<<(::std::ostream& os, const ::HIR::TypeRef& ty);
 
 }   // namespace HIR
 
+namespace std {
+    template<>
+    struct hash< ::HIR::TypeRef>
+    {
+        size_t operator()(const ::HIR::TypeRef& t) const {
+            return t.hash();
+        }
+    };
+}
+
 #endif
 
@@ -0,0 +1,88 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * hir/type_intern.cpp
+ * - Interned (hash-consed) type pool
+ */
+#include "type_intern.hpp"
+#include <deque>
+#include <mutex>
+
+namespace HIR {
+
+class InternedTypePool
+{
+    typedef InternedType::Node  Node;
+
+    // Split into shards (selected by hash) so worker threads rarely contend on the same lock
+    static const size_t NUM_SHARDS = 16;
+    struct Shard
+    {
+        ::std::mutex    lock;
+        // Storage for the types, `deque` doesn't move existing entries when it grows
+        ::std::deque<Node>  arena;
+        // Open-addressed hash table (linear probing) of pointers into `arena`, size is a power of two
+        ::std::vector<const Node*>  table;
+
+        void rehash()
+        {
+            ::std::vector<const Node*> new_table( table.empty() ? 256 : table.size() * 2 );
+            size_t  mask = new_table.size() - 1;
+            for(const auto* e : table)
+            {
+                if( !e )
+                    continue ;
+                size_t i = e->hash & mask;
+                while( new_table[i] )
+                    i = (i + 1) & mask;
+                new_table[i] = e;
+            }
+            table = ::std::move(new_table);
+        }
+    };
+    Shard   m_shards[NUM_SHARDS];
+
+public:
+    static InternedTypePool& get() {
+        // Never freed, interned types live until exit
+        static InternedTypePool* s_pool = new InternedTypePool();
+        return *s_pool;
+    }
+
+    // `owned` is used (moved from) if the type isn't already in the pool, otherwise `ty` is cloned
+    InternedType intern(const ::HIR::TypeRef& ty, ::HIR::TypeRef* owned)
+    {
+        size_t  hash = ty.hash();
+        auto& shard = m_shards[ (hash >> 24) % NUM_SHARDS ];
+        ::std::lock_guard<::std::mutex> lh { shard.lock };
+
+        // Keep the load factor below 1/2
+        if( shard.arena.size() * 2 >= shard.table.size() )
+            shard.rehash();
+
+        size_t  mask = shard.table.size() - 1;
+        size_t  i = hash & mask;
+        while( const auto* e = shard.table[i] )
+        {
+            if( e->hash == hash && e->ty.ord(ty) == OrdEqual )
+                return InternedType(e);
+            i = (i + 1) & mask;
+        }
+
+        shard.arena.push_back(Node { hash, owned ? mv$(*owned) : ty.clone() });
+        shard.table[i] = &shard.arena.back();
+        return InternedType(shard.table[i]);
+    }
+};
+
+InternedType InternedType::intern(const ::HIR::TypeRef& ty)
+{
+    return InternedTypePool::get().intern(ty, nullptr);
+}
+InternedType InternedType::intern(::HIR::TypeRef&& ty)
+{
+    return InternedTypePool::get().intern(ty, &ty);
+}
+
+}   // namespace HIR
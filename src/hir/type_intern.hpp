@@ -0,0 +1,77 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * hir/type_intern.hpp
+ * - Interned (hash-consed) types
+ */
+#pragma once
+
+#include <hir/type.hpp>
+
+namespace HIR {
+
+/// Handle to an interned type (for long-lived fully-resolved types in trans, e.g. cache keys)
+///
+/// Each distinct type (under `TypeRef::ord`) is stored once in a global pool and never freed, so copying is a
+/// pointer copy, equality is a pointer comparison, and the hash is computed once (when interned).
+class InternedType
+{
+public:
+    struct Node
+    {
+        size_t  hash;
+        ::HIR::TypeRef  ty;
+    };
+private:
+    friend class InternedTypePool;
+    const Node* m_ptr;
+
+    InternedType(const Node* p):
+        m_ptr(p)
+    {}
+public:
+    InternedType():
+        m_ptr(nullptr)
+    {}
+
+    static InternedType intern(const ::HIR::TypeRef& ty);
+    static InternedType intern(::HIR::TypeRef&& ty);
+
+    bool is_valid() const { return m_ptr != nullptr; }
+
+    const ::HIR::TypeRef& operator*() const { assert(m_ptr); return m_ptr->ty; }
+    const ::HIR::TypeRef* operator->() const { assert(m_ptr); return &m_ptr->ty; }
+    const ::HIR::TypeRef& get() const { return **this; }
+
+    size_t hash() const { return m_ptr ? m_ptr->hash : 0; }
+
+    bool operator==(const InternedType& x) const { return m_ptr == x.m_ptr; }
+    bool operator!=(const InternedType& x) const { return m_ptr != x.m_ptr; }
+    // NOTE: Ordering is by content (not by address), to keep sorted containers deterministic
+    Ordering ord(const InternedType& x) const {
+        if( m_ptr == x.m_ptr )  return OrdEqual;
+        if( !m_ptr )    return OrdLess;
+        if( !x.m_ptr )  return OrdGreater;
+        return m_ptr->ty.ord(x.m_ptr->ty);
+    }
+    bool operator<(const InternedType& x) const { return ord(x) == OrdLess; }
+
+    friend ::std::ostream& operator<<(::std::ostream& os, const InternedType& x) {
+        if( x.m_ptr )
+            return os << x.m_ptr->ty;
+        return os << "(null)";
+    }
+};
+
+}   // namespace HIR
+
+namespace std {
+    template<>
+    struct hash< ::HIR::InternedType>
+    {
+        size_t operator()(const ::HIR::InternedType& t) const {
+            return t.hash();
+        }
+    };
+}
@@ -14,6 +14,7 @@
 
 void ::HIR::Visitor::visit_crate(::HIR::Crate& crate)
 {
+    m_visited_crate = &crate;
     this->visit_module(::HIR::ItemPath(crate.m_crate_name), crate.m_root_module );
 
     for( auto& ty_impl : crate.m_type_impls )
@@ -28,6 +29,7 @@ void ::HIR::Visitor::visit_crate(::HIR::Crate& crate)
     {
         this->visit_marker_impl(impl.first, impl.second);
     }
+    m_visited_crate = nullptr;
 }
 
 void ::HIR::Visitor::visit_module(::HIR::ItemPath p, ::HIR::Module& mod)
@@ -123,7 +125,22 @@ void ::HIR::Visitor::visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR
         this->visit_generic_path(gp, PathContext::TRAIT);
         impl.m_trait_args = mv$(gp.m_params);
     }
-    this->visit_type(impl.m_type);
+    if( m_visited_crate )
+    {
+        // `Crate::find_trait_impls` indexes impls by their type, so the index is stale if visiting changed it
+        // - Invalidated before visiting the items, as they can look up impls
+        auto ty_before = impl.m_type.clone();
+        this->visit_type(impl.m_type);
+        if( impl.m_type != ty_before )
+        {
+            DEBUG("Impl type changed from " << ty_before << " to " << impl.m_type);
+            m_visited_crate->invalidate_trait_impl_index();
+        }
+    }
+    else
+    {
+        this->visit_type(impl.m_type);
+    }
 
     for(auto& ent : impl.m_methods) {
         DEBUG("method " << ent.first);
@@ -18,6 +18,8 @@ namespace HIR {
 // TODO: Split into Visitor and ItemVisitor
 class Visitor
 {
+    // Crate being visited by `visit_crate` (used to invalidate the trait impl index if an impl type changes)
+    ::HIR::Crate*   m_visited_crate = nullptr;
 public:
     virtual ~Visitor();
 
@@ -7,6 +7,7 @@
  */
 #include "common.hpp"
 #include <hir/path.hpp>
+#include <stats.hpp>
 
 bool visit_ty_with__path_params(const ::HIR::PathParams& tpl, t_cb_visit_ty callback)
 {
@@ -339,6 +340,7 @@ namespace {
 }
 ::HIR::TypeRef monomorphise_type_with(const Span& sp, const ::HIR::TypeRef& tpl, t_cb_generic callback, bool allow_infer)
 {
+    STATS_TIMER("monomorphise_type_with");
     ::HIR::TypeRef  rv;
     TRACE_FUNCTION_FR("tpl = " << tpl, rv);
     rv = monomorphise_type_with_inner(sp, tpl, callback, allow_infer);
@@ -4,6 +4,7 @@
 #include <hir/expr.hpp>
 #include <hir/visitor.hpp>
 #include "expr_visit.hpp"
+#include <parallel.hpp>
 
 namespace {
     void Typecheck_Code(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr) {
@@ -11,17 +12,33 @@ namespace {
         Typecheck_Code_CS(ms, args, result_type, expr);
     }
 
+    /// An item body to be checked, with a copy of the module state at the point it was found
+    struct BodyJob
+    {
+        ::typeck::ModuleState   ms;
+        t_args* args;   // nullptr for bodies without arguments
+        ::HIR::TypeRef  result_type;
+        ::HIR::ExprPtr* expr;
+    };
 
     class OuterVisitor:
         public ::HIR::Visitor
     {
         ::typeck::ModuleState m_ms;
+        ::std::vector<BodyJob>& m_jobs;
     public:
-        OuterVisitor(::HIR::Crate& crate):
-            m_ms(crate)
+        OuterVisitor(::HIR::Crate& crate, ::std::vector<BodyJob>& jobs):
+            m_ms(crate),
+            m_jobs(jobs)
         {
         }
 
+    private:
+        // Item bodies are independent, so they're checked after the visit (in parallel if enabled)
+        void defer_body(t_args* args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr) {
+            m_jobs.push_back(BodyJob { m_ms, args, result_type.clone(), &expr });
+        }
+
 
     public:
         void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
@@ -97,7 +114,7 @@ namespace {
             if( item.m_code )
             {
                 DEBUG("Function code " << p);
-                Typecheck_Code( m_ms, item.m_args, item.m_return, item.m_code );
+                defer_body( &item.m_args, item.m_return, item.m_code );
             }
             else
             {
@@ -109,8 +126,7 @@ namespace {
             if( item.m_value )
             {
                 DEBUG("Static value " << p);
-                t_args  tmp;
-                Typecheck_Code(m_ms, tmp, item.m_type, item.m_value);
+                defer_body(nullptr, item.m_type, item.m_value);
             }
         }
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
@@ -118,8 +134,7 @@ namespace {
             if( item.m_value )
             {
                 DEBUG("Const value " << p);
-                t_args  tmp;
-                Typecheck_Code(m_ms, tmp, item.m_type, item.m_value);
+                defer_body(nullptr, item.m_type, item.m_value);
             }
         }
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
@@ -135,8 +150,7 @@ namespace {
                     DEBUG("Enum value " << p << " - " << var.name);
                     if( var.expr )
                     {
-                        t_args  tmp;
-                        Typecheck_Code(m_ms, tmp, enum_type, var.expr);
+                        defer_body(nullptr, enum_type, var.expr);
                     }
                 }
             }
@@ -146,6 +160,14 @@ namespace {
 
 void Typecheck_Expressions(::HIR::Crate& crate)
 {
-    OuterVisitor    visitor { crate };
+    // NOTE: Array sizes are checked during the visit (the expression can be shared between type instances)
+    ::std::vector<BodyJob>  jobs;
+    OuterVisitor    visitor { crate, jobs };
     visitor.visit_crate( crate );
+
+    parallel_for(jobs.size(), [&](unsigned int , size_t idx) {
+        auto& job = jobs[idx];
+        t_args  tmp;
+        Typecheck_Code(job.ms, job.args ? *job.args : tmp, job.result_type, *job.expr);
+        });
 }
@@ -6,6 +6,13 @@
  * - Typecheck helpers
  */
 #include "helpers.hpp"
+#include <mutex>
+#include <stats.hpp>
+
+namespace {
+    // Lock for `TraitMarkings::auto_impls` (shared between bodies typechecked in parallel)
+    ::std::mutex    g_auto_impls_lock;
+}
 
 // --------------------------------------------------------------------
 // HMTypeInferrence
@@ -1085,6 +1092,7 @@ bool TraitResolution::find_trait_impls(const Span& sp,
         t_cb_trait_impl_r callback
         ) const
 {
+    STATS_TIMER("TraitResolution::find_trait_impls");
     static ::HIR::PathParams    null_params;
     static ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
 
@@ -1611,6 +1619,7 @@ bool TraitResolution::has_associated_type(const ::HIR::TypeRef& input) const
 }
 void TraitResolution::expand_associated_types_inplace(const Span& sp, ::HIR::TypeRef& input, LList<const ::HIR::TypeRef*> stack) const
 {
+    STATS_TIMER("TraitResolution::expand_associated_types");
     for(const auto& ty : m_eat_active_stack)
     {
         if( input == ty ) {
@@ -2348,7 +2357,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
     if( m_crate.get_trait_by_path(sp, trait).m_is_marker )
     {
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        static thread_local ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait )
                 continue ;
@@ -2397,13 +2406,17 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         // - Cache populated after destructure
         if( markings )
         {
+            ::std::unique_lock<::std::mutex>    lh { g_auto_impls_lock };
             auto it = markings->auto_impls.find( trait );
             if( it != markings->auto_impls.end() )
             {
-                if( ! it->second.conditions.empty() ) {
+                bool has_conditions = ! it->second.conditions.empty();
+                bool is_impled = it->second.is_impled;
+                lh.unlock();
+                if( has_conditions ) {
                     TODO(sp, "Conditional auto trait impl");
                 }
-                else if( it->second.is_impled ) {
+                else if( is_impled ) {
                     return callback( ImplRef(&type, params_ptr, &null_assoc), ::HIR::Compare::Equal );
                 }
                 else {
@@ -2487,6 +2500,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         {
             if( markings ) {
                 ASSERT_BUG(sp, cmp == ::HIR::Compare::Equal, "Auto trait with no params returned a fuzzy match from destructure");
+                ::std::lock_guard<::std::mutex> lh { g_auto_impls_lock };
                 markings->auto_impls.insert( ::std::make_pair(trait, ::HIR::TraitMarkings::AutoMarking { {}, true }) );
             }
             return callback( ImplRef(&type, params_ptr, &null_assoc), cmp );
@@ -2494,6 +2508,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         else
         {
             if( markings ) {
+                ::std::lock_guard<::std::mutex> lh { g_auto_impls_lock };
                 markings->auto_impls.insert( ::std::make_pair(trait, ::HIR::TraitMarkings::AutoMarking { {}, false }) );
             }
             return false;
@@ -7,6 +7,7 @@
  */
 #include "static.hpp"
 #include <algorithm>
+#include <stats.hpp>
 
 void StaticTraitResolve::prep_indexes()
 {
@@ -84,6 +85,87 @@ void StaticTraitResolve::prep_indexes()
         });
 }
 
+namespace {
+    // Auto trait impl searches in progress (used to detect recursion, see `find_impl__uncached`)
+    thread_local ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    s_auto_trait_stack;
+
+    /// Clone an `ImplRef` out of the `find_impl` cache (pointers into the cache entry are kept)
+    ImplRef clone_cached_impl_ref(const ImplRef& ir)
+    {
+        TU_MATCH(ImplRef::Data, (ir.m_data), (e),
+        (TraitImpl,
+            ::std::vector< ::HIR::TypeRef>  params_ph;
+            for(const auto& t : e.params_ph)
+                params_ph.push_back( t.clone() );
+            return ImplRef(e.params, *e.trait_path, *e.impl, mv$(params_ph));
+            ),
+        (BoundedPtr,
+            return ImplRef(e.type, e.trait_args, e.assoc);
+            ),
+        (Bounded,
+            ::std::map< ::std::string, ::HIR::TypeRef>  assoc;
+            for(const auto& a : e.assoc)
+                assoc.insert( ::std::make_pair(a.first, a.second.clone()) );
+            return ImplRef(e.type.clone(), e.trait_args.clone(), mv$(assoc));
+            )
+        )
+        throw "";
+    }
+}
+
+StaticTraitResolve::~StaticTraitResolve()
+{
+    if( m_find_impl_cache_hits > 0 || m_find_impl_cache_misses > 0 )
+    {
+        DEBUG("find_impl cache: " << m_find_impl_cache_hits << " hits, " << m_find_impl_cache_misses << " misses, " << m_find_impl_cache.size() << " entries");
+    }
+}
+
+bool StaticTraitResolve::find_impl__can_cache(const ::HIR::PathParams* trait_params, const ::HIR::TypeRef& type) const
+{
+    // Bounds in scope can add impls
+    if( m_impl_generics && !m_impl_generics->m_bounds.empty() )
+        return false;
+    if( m_item_generics && !m_item_generics->m_bounds.empty() )
+        return false;
+    // Results found while checking an auto trait can depend on the outer query (recursion is assumed to succeed)
+    if( !s_auto_trait_stack.empty() )
+        return false;
+    // Supertrait lookups on these don't stop when the callback returns true, so can't be replayed
+    if( type.m_data.is_TraitObject() || type.m_data.is_ErasedType() )
+        return false;
+
+    // Only fully known types (no inference variables, generics, or unresolved paths)
+    auto is_unknown = [](const ::HIR::TypeRef& ty)->bool {
+        TU_MATCH_DEF(::HIR::TypeRef::Data, (ty.m_data), (e),
+        (
+            return false;
+            ),
+        (Infer,
+            return true;
+            ),
+        (Generic,
+            return true;
+            ),
+        (Closure,
+            return true;
+            ),
+        (Path,
+            return !e.path.m_data.is_Generic() || e.binding.is_Unbound() || e.binding.is_Opaque();
+            )
+        )
+        };
+    if( visit_ty_with(type, is_unknown) )
+        return false;
+    if( trait_params )
+    {
+        for(const auto& ty : trait_params->m_types)
+            if( visit_ty_with(ty, is_unknown) )
+                return false;
+    }
+    return true;
+}
+
 bool StaticTraitResolve::find_impl(
     const Span& sp,
     const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
@@ -91,6 +173,106 @@ bool StaticTraitResolve::find_impl(
     t_cb_find_impl found_cb,
     bool dont_handoff_to_specialised
     ) const
+{
+    STATS_TIMER("StaticTraitResolve::find_impl");
+    if( dont_handoff_to_specialised || !this->find_impl__can_cache(trait_params, type) )
+    {
+        return this->find_impl__uncached(sp, trait_path, trait_params, type, mv$(found_cb), dont_handoff_to_specialised);
+    }
+
+    size_t impl_count = m_crate.m_trait_impls.size() + m_crate.m_marker_impls.size();
+    if( impl_count != m_find_impl_cache_impl_count )
+    {
+        m_find_impl_cache.clear();
+        m_find_impl_cache_impl_count = impl_count;
+    }
+
+    auto key = ::std::make_tuple(trait_path.clone(), trait_params != nullptr, trait_params ? trait_params->clone() : ::HIR::PathParams(), type.clone());
+    auto it = m_find_impl_cache.find(key);
+    if( it == m_find_impl_cache.end() )
+    {
+        m_find_impl_cache_misses ++;
+        it = m_find_impl_cache.insert( ::std::make_pair(mv$(key), FindImplCacheEnt()) ).first;
+    }
+    else
+    {
+        m_find_impl_cache_hits ++;
+        DEBUG("find_impl cache hit: " << trait_path << " for " << type << " (" << m_find_impl_cache_hits << " hits, " << m_find_impl_cache_misses << " misses)");
+    }
+    auto& ent = it->second;
+    if( ent.in_progress )
+    {
+        return this->find_impl__uncached(sp, trait_path, trait_params, type, mv$(found_cb), false);
+    }
+
+    // Replay known results (by index, the callback could add to the list)
+    for(size_t i = 0; i < ent.results.size(); i ++)
+    {
+        const auto& r = ent.results[i];
+        if( found_cb(clone_cached_impl_ref(r.impl), r.is_fuzzed) )
+            return true;
+    }
+    if( ent.complete )
+        return ent.rv;
+
+    // Run (or resume) the search, skipping the results that were just replayed
+    const auto& cached_trait_path = ::std::get<0>(it->first);
+    size_t  n_skip = ent.results.size();
+    bool    stopped = false;
+    ent.in_progress = true;
+    bool rv = this->find_impl__uncached(sp, trait_path, trait_params, type, [&](ImplRef impl, bool is_fuzzed)->bool {
+        if( n_skip > 0 ) {
+            n_skip --;
+            return false;
+        }
+        // Store an owned copy (`impl` can point into the query)
+        FindImplCacheEnt::Result   r { ImplRef(), is_fuzzed, {} };
+        TU_MATCH(ImplRef::Data, (impl.m_data), (e),
+        (TraitImpl,
+            for(const auto* p : e.params)
+                r.param_storage.push_back( p ? p->clone() : ::HIR::TypeRef() );
+            ::std::vector<const ::HIR::TypeRef*>    params;
+            for(size_t i = 0; i < e.params.size(); i ++)
+                params.push_back( e.params[i] ? &r.param_storage[i] : nullptr );
+            ::std::vector< ::HIR::TypeRef>  params_ph;
+            for(const auto& t : e.params_ph)
+                params_ph.push_back( t.clone() );
+            r.impl = ImplRef(mv$(params), cached_trait_path, *e.impl, mv$(params_ph));
+            ),
+        (BoundedPtr,
+            ::std::map< ::std::string, ::HIR::TypeRef>  assoc;
+            for(const auto& a : *e.assoc)
+                assoc.insert( ::std::make_pair(a.first, a.second.clone()) );
+            r.impl = ImplRef(e.type->clone(), e.trait_args->clone(), mv$(assoc));
+            ),
+        (Bounded,
+            r.impl = clone_cached_impl_ref(impl);
+            )
+        )
+        ent.results.push_back( mv$(r) );
+
+        if( found_cb(mv$(impl), is_fuzzed) ) {
+            stopped = true;
+            return true;
+        }
+        return false;
+        }, false);
+    ent.in_progress = false;
+    if( !stopped )
+    {
+        ent.complete = true;
+        ent.rv = rv;
+    }
+    return rv;
+}
+
+bool StaticTraitResolve::find_impl__uncached(
+    const Span& sp,
+    const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+    const ::HIR::TypeRef& type,
+    t_cb_find_impl found_cb,
+    bool dont_handoff_to_specialised
+    ) const
 {
     TRACE_FUNCTION_F(trait_path << FMT_CB(os, if(trait_params) { os << *trait_params; } else { os << "<?>"; }) << " for " << type);
     auto cb_ident = [](const ::HIR::TypeRef&ty)->const ::HIR::TypeRef& { return ty; };
@@ -369,7 +551,7 @@ bool StaticTraitResolve::find_impl(
             return rv;
 
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        auto& stack = s_auto_trait_stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait_path )
                 continue ;
@@ -382,7 +564,7 @@ bool StaticTraitResolve::find_impl(
         }
         stack.push_back( ::std::make_tuple( &trait_path, trait_params, &type ) );
         struct Guard {
-            ~Guard() { stack.pop_back(); }
+            ~Guard() { s_auto_trait_stack.pop_back(); }
         };
         Guard   _;
 
@@ -838,6 +1020,7 @@ bool StaticTraitResolve::find_impl__check_crate(
 
 void StaticTraitResolve::expand_associated_types(const Span& sp, ::HIR::TypeRef& input) const
 {
+    STATS_TIMER("StaticTraitResolve::expand_associated_types");
     TRACE_FUNCTION_F(input);
     this->expand_associated_types_inner(sp, input);
 }
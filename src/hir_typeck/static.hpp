@@ -35,6 +35,31 @@ public:
 private:
     mutable ::std::map< ::HIR::TypeRef, bool >  m_copy_cache;
 
+    /// Memoised result of a `find_impl` query (for queries that don't depend on inference or the generic scope)
+    struct FindImplCacheEnt
+    {
+        struct Result {
+            ImplRef impl;
+            bool    is_fuzzed;
+            /// Owned copies of the types that `impl` points to (for `TraitImpl` results)
+            ::std::vector< ::HIR::TypeRef>  param_storage;
+        };
+        /// Results in the order the search found them
+        ::std::vector<Result>   results;
+        /// Set once the search has run to completion (i.e. all callbacks returned false), `rv` is then its return value
+        bool    complete = false;
+        bool    rv = false;
+        /// Set while the search is being resumed, to avoid re-entering it
+        bool    in_progress = false;
+    };
+    // Key: trait path, trait params (if present), type
+    typedef ::std::tuple< ::HIR::SimplePath, bool, ::HIR::PathParams, ::HIR::TypeRef>   t_find_impl_cache_key;
+    mutable ::std::map< t_find_impl_cache_key, FindImplCacheEnt>    m_find_impl_cache;
+    /// Number of impls in the crate when the cache was filled (new impls invalidate it)
+    mutable size_t  m_find_impl_cache_impl_count = 0;
+    mutable unsigned int    m_find_impl_cache_hits = 0;
+    mutable unsigned int    m_find_impl_cache_misses = 0;
+
 public:
     StaticTraitResolve(const ::HIR::Crate& crate):
         m_crate(crate),
@@ -52,6 +77,7 @@ public:
         m_lang_PhantomData = m_crate.get_lang_item_path_opt("phantom_data");
         prep_indexes();
     }
+    ~StaticTraitResolve();
 
 private:
     void prep_indexes();
@@ -96,6 +122,13 @@ public:
         prep_indexes();
         return NullOnDrop< ::HIR::GenericParams>(m_item_generics);
     }
+    /// Replace both generic scopes at once (either can be null), for use outside of a visitor
+    void set_generics(::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics) {
+        m_impl_generics = impl_generics;
+        m_item_generics = item_generics;
+        m_type_equalities.clear();
+        prep_indexes();
+    }
     /// \}
 
     /// \brief Lookups
@@ -120,6 +153,15 @@ public:
         ) const;
 
 private:
+    /// Returns true if the result of this query can be memoised (see `m_find_impl_cache`)
+    bool find_impl__can_cache(const ::HIR::PathParams* trait_params, const ::HIR::TypeRef& type) const;
+    bool find_impl__uncached(
+        const Span& sp,
+        const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+        const ::HIR::TypeRef& type,
+        t_cb_find_impl found_cb,
+        bool dont_handoff_to_specialised
+        ) const;
     bool find_impl__check_bound(
         const Span& sp,
         const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
@@ -1,19 +1,42 @@
 /*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/debug.hpp
+ * - Debug output (`DEBUG`, `TRACE_FUNCTION*`)
+ *
+ * Output is enabled per compiler phase (see `MRUSTC_DEBUG`). When disabled, each `DEBUG`/`TRACE_FUNCTION*` costs a
+ * single load+branch of `g_debug_enabled`. The message is only formatted when the branch is taken.
+ *
+ * Building with `MRUSTC_DISABLE_DEBUG` defined (`make DISABLE_DEBUG=1`) compiles debug output out entirely.
  */
 #pragma once
 #include <sstream>
 #include <cassert>
 #include <functional>
 
-extern int g_debug_indent_level;
+extern thread_local int g_debug_indent_level;
+
+#ifdef MRUSTC_DISABLE_DEBUG
+# ifndef DISABLE_DEBUG
+#  define DISABLE_DEBUG
+# endif
+#endif
+
+#if defined(__GNUC__)
+# define DEBUG_UNLIKELY(x)  __builtin_expect(!!(x), 0)
+#else
+# define DEBUG_UNLIKELY(x)  (x)
+#endif
 
 #ifndef DISABLE_DEBUG
 # define INDENT()    do { g_debug_indent_level += 1; assert(g_debug_indent_level<300); } while(0)
 # define UNINDENT()    do { g_debug_indent_level -= 1; } while(0)
-# define DEBUG(ss)   do{ if(debug_enabled()) { debug_output(g_debug_indent_level, __FUNCTION__) << ss << ::std::endl; } } while(0)
+# define DEBUG(ss)   do{ if(DEBUG_UNLIKELY(debug_enabled())) { debug_output(g_debug_indent_level, __FUNCTION__) << ss << ::std::endl; } } while(0)
 # define TRACE_FUNCTION  TraceLog _tf_(__func__)
 # define TRACE_FUNCTION_F(ss)    TraceLog _tf_(__func__, [&](::std::ostream&__os){ __os << ss; })
-# define TRACE_FUNCTION_FR(ss,ss2)    TraceLog _tf_(__func__, [&](::std::ostream&__os){ __os << ss; }, [&](::std::ostream&__os){ __os << ss2;})
+// NOTE: The return formatter is a named local (declared before `_tf_`) so `TraceLog` can refer to it without storing a copy
+# define TRACE_FUNCTION_FR(ss,ss2)    auto _tf_ret_ = [&](::std::ostream&__os){ __os << ss2; }; TraceLog _tf_(__func__, [&](::std::ostream&__os){ __os << ss; }, _tf_ret_)
 #else
 # define INDENT()    do { } while(0)
 # define UNINDENT()    do {} while(0)
@@ -23,7 +46,17 @@ extern int g_debug_indent_level;
 # define TRACE_FUNCTION_FR(ss,ss2)  do{ if(false) (void)(::NullSink() << ss); if(false) (void)(::NullSink() << ss2); } while(0)
 #endif
 
-extern bool debug_enabled();
+/// Set when the current phase has debug output enabled (updated by the phase runner in main.cpp)
+extern bool g_debug_enabled;
+#ifndef MRUSTC_DISABLE_DEBUG
+static inline bool debug_enabled() {
+    return g_debug_enabled;
+}
+#else
+static inline constexpr bool debug_enabled() {
+    return false;
+}
+#endif
 extern ::std::ostream& debug_output(int indent, const char* function);
 
 struct RepeatLitStr
@@ -48,15 +81,69 @@ public:
     const NullSink& operator<<(const T&) const { return *this;  }
 };
 
+/// Non-owning reference to a formatting callback (avoids `::std::function` construction on the disabled path)
+class TraceFmtRef
+{
+    const void* m_ptr;
+    void (*m_fcn)(const void*, ::std::ostream&);
+public:
+    TraceFmtRef():
+        m_ptr(nullptr),
+        m_fcn(nullptr)
+    {}
+    template<typename T>
+    TraceFmtRef(const T& cb):
+        m_ptr(&cb),
+        m_fcn([](const void* p, ::std::ostream& os) { (*static_cast<const T*>(p))(os); })
+    {}
+    void operator()(::std::ostream& os) const {
+        if( m_fcn )
+            m_fcn(m_ptr, os);
+    }
+};
+
 class TraceLog
 {
+    // `nullptr` if debug output was disabled on entry (then nothing is printed, and the indent is untouched)
     const char* m_tag;
-    ::std::function<void(::std::ostream&)>  m_ret;
+    TraceFmtRef m_ret;
+
+    void enter(const char* tag, const TraceFmtRef* info_cb);
+    void leave();
 public:
-    TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb, ::std::function<void(::std::ostream&)> ret);
-    TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb);
-    TraceLog(const char* tag);
-    ~TraceLog();
+    template<typename InfoCb, typename RetCb>
+    TraceLog(const char* tag, const InfoCb& info_cb, const RetCb& ret):
+        m_tag(nullptr)
+    {
+        if( DEBUG_UNLIKELY(debug_enabled()) ) {
+            m_ret = TraceFmtRef(ret);
+            TraceFmtRef info { info_cb };
+            enter(tag, &info);
+        }
+    }
+    template<typename InfoCb>
+    TraceLog(const char* tag, const InfoCb& info_cb):
+        m_tag(nullptr)
+    {
+        if( DEBUG_UNLIKELY(debug_enabled()) ) {
+            TraceFmtRef info { info_cb };
+            enter(tag, &info);
+        }
+    }
+    TraceLog(const char* tag):
+        m_tag(nullptr)
+    {
+        if( DEBUG_UNLIKELY(debug_enabled()) ) {
+            enter(tag, nullptr);
+        }
+    }
+    TraceLog(const TraceLog&) = delete;
+    TraceLog& operator=(const TraceLog&) = delete;
+    ~TraceLog() {
+        if( DEBUG_UNLIKELY(m_tag != nullptr) ) {
+            leave();
+        }
+    }
 };
 
 struct FmtLambda
@@ -8,6 +8,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <rc_string.hpp>
 
 struct Ident
 {
@@ -59,17 +60,21 @@ struct Ident
     };
 
     Hygiene hygiene;
-    ::std::string   name;
+    RcString    name;
 
     Ident(const char* name):
         hygiene(),
         name(name)
     { }
-    Ident(::std::string name):
+    Ident(RcString name):
         hygiene(),
         name(::std::move(name))
     { }
-    Ident(Hygiene hygiene, ::std::string name):
+    Ident(const ::std::string& name):
+        hygiene(),
+        name(name)
+    { }
+    Ident(Hygiene hygiene, RcString name):
         hygiene(::std::move(hygiene)), name(::std::move(name))
     { }
 
@@ -79,7 +84,7 @@ struct Ident
     Ident& operator=(const Ident& x) = default;
 
     ::std::string into_string() {
-        return ::std::move(name);
+        return name.str();
     }
 
     bool operator==(const char* s) const {
@@ -29,5 +29,8 @@ extern AST::Flat Convert_Flatten(const AST::Crate& crate);
 /// Dump the crate as annotated rust
 extern void Dump_Rust(const char *Filename, const AST::Crate& crate);
 
+/// Run as a compile server (`mrustc --compile-server`), calling `compile` for each job
+extern int CompileServer_Run(const char* argv0, int (*compile)(int argc, char *argv[]));
+
 #endif
 
@@ -0,0 +1,80 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/parallel.hpp
+ * - Helpers for running independent jobs on worker threads
+ */
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <functional>
+#include <debug.hpp>
+
+/// Number of worker threads to use for parallel phases (set with `-j`, defaults to 1)
+extern unsigned int g_num_worker_threads;
+
+/// Number of workers that `parallel_for` will use for `count` jobs
+static inline unsigned int parallel_worker_count(size_t count)
+{
+    // Debug output from multiple threads is unreadable, so stay serial if it's on
+    if( g_num_worker_threads <= 1 || count <= 1 || debug_enabled() )
+        return 1;
+    return static_cast<unsigned int>( ::std::min<size_t>(g_num_worker_threads, count) );
+}
+
+/// Call `cb(worker_index, job_index)` for every job in `0 .. count`
+///
+/// Jobs are handed out in index order, `worker_index` is less than `parallel_worker_count(count)` (so callers can keep
+/// per-worker state). If any job throws, remaining jobs are abandoned and the first exception is re-thrown here.
+static inline void parallel_for(size_t count, ::std::function<void(unsigned int worker_index, size_t job_index)> cb)
+{
+    unsigned int n_workers = parallel_worker_count(count);
+    if( n_workers == 1 )
+    {
+        for(size_t i = 0; i < count; i ++)
+            cb(0, i);
+        return ;
+    }
+
+    ::std::atomic<size_t>   next_job { 0 };
+    ::std::atomic<bool> failed { false };
+    ::std::exception_ptr    first_exception;
+    ::std::mutex    exception_lock;
+
+    auto worker = [&](unsigned int worker_index) {
+        for(;;)
+        {
+            if( failed.load() )
+                break;
+            size_t idx = next_job.fetch_add(1);
+            if( idx >= count )
+                break;
+            try
+            {
+                cb(worker_index, idx);
+            }
+            catch(...)
+            {
+                ::std::lock_guard<::std::mutex> lh { exception_lock };
+                if( !first_exception )
+                    first_exception = ::std::current_exception();
+                failed = true;
+            }
+        }
+        };
+
+    ::std::vector<::std::thread>    threads;
+    threads.reserve(n_workers - 1);
+    for(unsigned int i = 1; i < n_workers; i ++)
+        threads.push_back( ::std::thread(worker, i) );
+    worker(0);
+    for(auto& t : threads)
+        t.join();
+
+    if( first_exception )
+        ::std::rethrow_exception(first_exception);
+}
@@ -1,20 +1,43 @@
 /*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/rc_string.hpp
+ * - Interned (immutable, de-duplicated) string
  */
 #pragma once
 
 #include <cstring>
+#include <string>
 #include <ostream>
+#include <functional>
 
+/// Interned string (used for identifiers, path components, file names)
+///
+/// Every distinct string is stored once (in a global arena, and never freed), so copying is a pointer copy and
+/// equality is a pointer comparison. The hash is computed once, when the string is interned.
+///
+/// Converts to `const ::std::string&`, so can be passed to code expecting a `::std::string`.
 class RcString
 {
-    unsigned int*   m_ptr;
-    unsigned int    m_len;
+    struct Inner
+    {
+        size_t  hash;
+        ::std::string   str;
+    };
+    friend class RcStringPool;
+
+    const Inner*    m_ptr;
+
+    static const ::std::string& empty_str() {
+        static const ::std::string  s_empty;
+        return s_empty;
+    }
 public:
     RcString():
-        m_ptr(nullptr),
-        m_len(0)
+        m_ptr(nullptr)
     {}
-    RcString(const char* s, unsigned int len);
+    RcString(const char* s, size_t len);
     RcString(const char* s):
         RcString(s, ::std::strlen(s))
     {
@@ -24,60 +47,78 @@ public:
     {
     }
 
-    RcString(const RcString& x):
-        m_ptr(x.m_ptr),
-        m_len(x.m_len)
-    {
-        if( m_ptr ) *m_ptr += 1;
-    }
-    RcString(RcString&& x):
-        m_ptr(x.m_ptr),
-        m_len(x.m_len)
-    {
-        x.m_ptr = nullptr;
-        x.m_len = 0;
-    }
+    RcString(const RcString& x) = default;
+    RcString& operator=(const RcString& x) = default;
 
-    ~RcString();
+    /// Hash function used for interned strings (`hash()` returns this for the string's contents)
+    static size_t hash_bytes(const char* s, size_t len);
 
-    RcString& operator=(const RcString& x)
-    {
-        if( &x != this )
-        {
-            this->~RcString();
-            m_ptr = x.m_ptr;
-            m_len = x.m_len;
-            if( m_ptr ) *m_ptr += 1;
-        }
-        return *this;
+    const ::std::string& str() const {
+        return m_ptr ? m_ptr->str : empty_str();
     }
-    RcString& operator=(RcString&& x)
-    {
-        if( &x != this )
-        {
-            this->~RcString();
-            m_ptr = x.m_ptr;
-            m_len = x.m_len;
-            x.m_ptr = nullptr;
-            x.m_len = 0;
-        }
-        return *this;
+    operator const ::std::string&() const {
+        return str();
     }
-
-
     const char* c_str() const {
-        if( m_len > 0 )
-        {
-            return reinterpret_cast<const char*>(m_ptr + 1);
-        }
-        else
-        {
-            return "";
-        }
+        return str().c_str();
+    }
+    size_t size() const {
+        return str().size();
+    }
+    bool empty() const {
+        return m_ptr == nullptr;
+    }
+    size_t hash() const {
+        return m_ptr ? m_ptr->hash : 0;
+    }
+    char operator[](size_t i) const {
+        return str()[i];
+    }
+    ::std::string::const_iterator begin() const { return str().begin(); }
+    ::std::string::const_iterator end() const { return str().end(); }
+
+    int compare(const RcString& x) const {
+        if( m_ptr == x.m_ptr )
+            return 0;
+        return str().compare(x.str());
     }
-    bool operator==(const RcString& s) const { return *this == s.c_str(); }
-    bool operator==(const char* s) const;
+
+    // NOTE: Ordering is by content (not by address), to keep sorted containers deterministic
+    friend bool operator==(const RcString& a, const RcString& b) { return a.m_ptr == b.m_ptr; }
+    friend bool operator!=(const RcString& a, const RcString& b) { return a.m_ptr != b.m_ptr; }
+    friend bool operator< (const RcString& a, const RcString& b) { return a.compare(b) <  0; }
+    friend bool operator> (const RcString& a, const RcString& b) { return a.compare(b) >  0; }
+    friend bool operator<=(const RcString& a, const RcString& b) { return a.compare(b) <= 0; }
+    friend bool operator>=(const RcString& a, const RcString& b) { return a.compare(b) >= 0; }
+
+    friend bool operator==(const RcString& a, const char* b) { return a.str() == b; }
+    friend bool operator!=(const RcString& a, const char* b) { return a.str() != b; }
+    friend bool operator==(const char* a, const RcString& b) { return b.str() == a; }
+    friend bool operator!=(const char* a, const RcString& b) { return b.str() != a; }
+    friend bool operator==(const RcString& a, const ::std::string& b) { return a.str() == b; }
+    friend bool operator!=(const RcString& a, const ::std::string& b) { return a.str() != b; }
+    friend bool operator==(const ::std::string& a, const RcString& b) { return a == b.str(); }
+    friend bool operator!=(const ::std::string& a, const RcString& b) { return a != b.str(); }
+    friend bool operator< (const RcString& a, const ::std::string& b) { return a.str() < b; }
+    friend bool operator< (const ::std::string& a, const RcString& b) { return a < b.str(); }
+
+    friend ::std::string operator+(const RcString& a, const RcString& b) { return a.str() + b.str(); }
+    friend ::std::string operator+(const RcString& a, const char* b) { return a.str() + b; }
+    friend ::std::string operator+(const char* a, const RcString& b) { return a + b.str(); }
+    friend ::std::string operator+(const RcString& a, const ::std::string& b) { return a.str() + b; }
+    friend ::std::string operator+(const ::std::string& a, const RcString& b) { return a + b.str(); }
+
     friend ::std::ostream& operator<<(::std::ostream& os, const RcString& x) {
-        return os << x.c_str();
+        return os << x.str();
     }
 };
+
+namespace std {
+    template<>
+    struct hash<RcString>
+    {
+        size_t operator()(const RcString& s) const {
+            return s.hash();
+        }
+    };
+}
@@ -0,0 +1,90 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/stats.hpp
+ * - Hot-path counters and sampled timers (reported by `--stats`)
+ *
+ * When `--stats` isn't passed, each `STATS_COUNT`/`STATS_TIMER` costs a single branch on `Stats::g_enabled`.
+ * When it is, every hit increments a (relaxed atomic) counter, and one in `SAMPLE_PERIOD` hits (per thread) is timed.
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__GNUC__)
+# define STATS_UNLIKELY(x)  __builtin_expect(!!(x), 0)
+#else
+# define STATS_UNLIKELY(x)  (x)
+#endif
+
+namespace Stats {
+
+extern bool g_enabled;
+
+/// Only time one call in this many (keeps the overhead of timing very hot functions low)
+static const unsigned SAMPLE_PERIOD = 64;
+
+/// A named counter, registered on construction (use the `STATS_*` macros to declare a function-local instance)
+struct Counter
+{
+    const char* name;
+    ::std::atomic<uint64_t> count;
+    /// Number of calls that were timed, and their total time (inclusive of callees, including recursion)
+    ::std::atomic<uint64_t> samples;
+    ::std::atomic<uint64_t> sampled_ns;
+    Counter*    next;
+
+    Counter(const char* name);
+};
+
+extern thread_local unsigned t_sample_tick;
+
+static inline void count(Counter& c) {
+    if( STATS_UNLIKELY(g_enabled) ) {
+        c.count.fetch_add(1, ::std::memory_order_relaxed);
+    }
+}
+
+class ScopedTimer
+{
+    Counter*    m_counter;
+    ::std::chrono::steady_clock::time_point m_start;
+public:
+    ScopedTimer(Counter& c):
+        m_counter(nullptr)
+    {
+        if( STATS_UNLIKELY(g_enabled) ) {
+            c.count.fetch_add(1, ::std::memory_order_relaxed);
+            if( ++t_sample_tick % SAMPLE_PERIOD == 0 ) {
+                m_counter = &c;
+                m_start = ::std::chrono::steady_clock::now();
+            }
+        }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+        if( m_counter ) {
+            auto ns = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - m_start).count();
+            m_counter->samples.fetch_add(1, ::std::memory_order_relaxed);
+            m_counter->sampled_ns.fetch_add(static_cast<uint64_t>(ns), ::std::memory_order_relaxed);
+        }
+    }
+};
+
+/// Start a new report (ignores anything counted before this point)
+extern void begin();
+/// Record the counter values accumulated since the last call against the named phase
+extern void end_phase(const char* phase_name);
+/// Print per-phase tables (and totals) of all counters
+extern void print_report(::std::ostream& os);
+
+}   // namespace Stats
+
+/// Count calls to the enclosing scope
+#define STATS_COUNT(name)   do { static ::Stats::Counter _stats_ctr_ { name }; ::Stats::count(_stats_ctr_); } while(0)
+/// Count calls to the enclosing scope, and time a sample of them
+#define STATS_TIMER(name)   static ::Stats::Counter _stats_ctr_ { name }; ::Stats::ScopedTimer _stats_timer_ { _stats_ctr_ }
@@ -14,6 +14,7 @@
 #include "pattern_checks.hpp"
 #include <parse/interpolated_fragment.hpp>
 #include <ast/expr.hpp>
+#include <stats.hpp>
 
 class ParameterMappings
 {
@@ -583,7 +584,8 @@ class MacroExpander:
     MacroExpandState    m_state;
 
     Token   m_next_token;   // used for inserting a single token into the stream
-    ::std::unique_ptr<TTStreamO> m_ttstream;
+    // Stream over a substituted `tt` capture (borrowed from `m_mappings`)
+    ::std::unique_ptr<TokenStream> m_ttstream;
     Ident::Hygiene  m_hygiene;
 
 public:
@@ -603,6 +605,7 @@ public:
     ::std::shared_ptr<Span> outerSpan() const override;
     Ident::Hygiene realGetHygiene() const override;
     Token realGetToken() override;
+    bool realTakeTT(TokenTree& out) override;
 };
 
 void Macro_InitDefaults()
@@ -729,6 +732,7 @@ InterpolatedFragment Macro_HandlePatternCap(TokenStream& lex, MacroPatEnt::Type
 /// Parse the input TokenTree according to the `macro_rules!` patterns and return a token stream of the replacement
 ::std::unique_ptr<TokenStream> Macro_InvokeRules(const char *name, const MacroRules& rules, const Span& sp, TokenTree input, AST::Module& mod)
 {
+    STATS_TIMER("macro_rules invocation");
     TRACE_FUNCTION_F("'" << name << "', " << input);
 
     ParameterMappings   bound_tts;
@@ -1893,19 +1897,70 @@ namespace
     }
 }
 
+namespace {
+    /// The literal token that an arm's pattern must start with (nullptr if it can start with anything else)
+    const Token* get_arm_first_token(const ::std::vector<MacroPatEnt>& pattern)
+    {
+        if( pattern.empty() )
+            return nullptr;
+        const auto& pat = pattern[0];
+        switch(pat.type)
+        {
+        case MacroPatEnt::PAT_TOKEN:
+            return &pat.tok;
+        case MacroPatEnt::PAT_LOOP:
+            // `$(...)+` is always entered, so starts with its first entry
+            if( pat.name == "+" )
+                return get_arm_first_token(pat.subpats);
+            return nullptr;
+        default:
+            return nullptr;
+        }
+    }
+    /// Check if an arm could match an input starting with a token of type `first`
+    bool arm_can_start_with(const ::std::vector<MacroPatEnt>& pattern, eTokenType first)
+    {
+        if( pattern.empty() )
+            return first == TOK_EOF;
+        if( const auto* tok = get_arm_first_token(pattern) )
+            return tok->type() == first;
+        if( pattern[0].type == MacroPatEnt::PAT_IDENT )
+            return first == TOK_IDENT || is_reserved_word(first);
+        return true;
+    }
+    /// Get the arms (in order) that could match an input starting with `first_tok`
+    const ::std::vector<unsigned int>& get_candidate_arms(const MacroRules& rules, eTokenType first)
+    {
+        auto it = rules.m_arms_by_first_token.find(first);
+        if( it == rules.m_arms_by_first_token.end() )
+        {
+            ::std::vector<unsigned int> arms;
+            for(unsigned int i = 0; i < rules.m_rules.size(); i ++)
+            {
+                if( arm_can_start_with(rules.m_rules[i].m_pattern, first) )
+                    arms.push_back(i);
+            }
+            it = rules.m_arms_by_first_token.insert(::std::make_pair( static_cast<int>(first), mv$(arms) )).first;
+        }
+        return it->second;
+    }
+}
+
 unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& rules, TokenTree input, AST::Module& mod,  ParameterMappings& bound_tts)
 {
     TRACE_FUNCTION;
 
-    struct ActiveArm {
-        unsigned int    index;
-        MacroPatternStream  pat_stream;
-        TokenStreamRO   in_stream;
-    };
-
+    // Only arms that can start with the first input token are tried (and the first to match is used)
+    auto first_lex = TokenStreamRO(input);
+    const auto& first_tok = first_lex.next_tok();
     ::std::vector<size_t>   matches;
-    for(size_t i = 0; i < rules.m_rules.size(); i ++)
+    for(unsigned int i : get_candidate_arms(rules, first_tok.type()))
     {
+        // Same type, but the token's value (e.g. an identifier's name) can still differ
+        const auto* arm_first = get_arm_first_token(rules.m_rules[i].m_pattern);
+        if( arm_first && *arm_first != first_tok )
+            continue ;
+        STATS_COUNT("macro_rules arm match attempts");
         auto lex = TokenStreamRO(input);
         auto arm_stream = MacroPatternStream(rules.m_rules[i].m_pattern);
 
@@ -1971,6 +2026,7 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
         {
             matches.push_back(i);
             DEBUG(i << " MATCHED");
+            break;
         }
         else
         {
@@ -1987,7 +2043,6 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
     {
         // yay!
 
-        // NOTE: There can be multiple arms active, take the first.
         auto i = matches[0];
         DEBUG("Evalulating arm " << i);
 
@@ -2453,14 +2508,8 @@ Token MacroExpander::realGetToken()
                 DEBUG("Insert replacement #" << e << " = " << *frag);
                 if( frag->m_type == InterpolatedFragment::TT )
                 {
-                    if( can_steal )
-                    {
-                        m_ttstream.reset( new TTStreamO(*this->outerSpan(), mv$(frag->as_tt()) ) );
-                    }
-                    else
-                    {
-                        m_ttstream.reset( new TTStreamO(*this->outerSpan(), frag->as_tt().clone() ) );
-                    }
+                    // Read directly from the (shared) capture, `m_mappings` outlives the stream
+                    m_ttstream.reset( new TTStream(*this->outerSpan(), frag->as_tt()) );
                     return m_ttstream->getToken();
                 }
                 else
@@ -2490,6 +2539,14 @@ Token MacroExpander::realGetToken()
     return Token(TOK_EOF);
 }
 
+bool MacroExpander::realTakeTT(TokenTree& out)
+{
+    // Only a group within a substituted capture can be taken
+    if( m_next_token.type() != TOK_NULL || !m_ttstream )
+        return false;
+    return m_ttstream->take_tt(out);
+}
+
 const MacroExpansionEnt* MacroExpandState::next_ent()
 {
     //DEBUG("ofs " << m_offsets << " < " << m_root_contents.size());
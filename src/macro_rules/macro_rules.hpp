@@ -12,6 +12,7 @@
 #include "parse/tokentree.hpp"
 #include <common.hpp>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <cstring>
 #include "macro_rules_ptr.hpp"
@@ -147,6 +148,10 @@ public:
     /// Expansion rules
     ::std::vector<MacroRulesArm>  m_rules;
 
+    /// Arms that could match an input starting with each token type (filled on first use by `Macro_InvokeRules`)
+    /// NOTE: Not locked, macro expansion is single-threaded
+    mutable ::std::unordered_map<int, ::std::vector<unsigned int>>  m_arms_by_first_token;
+
     MacroRules()
     {
     }
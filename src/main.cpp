@@ -7,8 +7,13 @@
  */
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <string>
 #include <set>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include "parse/lex.hpp"
 #include "parse/parseerror.hpp"
 #include "ast/ast.hpp"
@@ -16,6 +21,8 @@
 #include <serialiser_texttree.hpp>
 #include <cstring>
 #include <main_bindings.hpp>
+#include <parallel.hpp>
+#include <stats.hpp>
 #include "resolve/main_bindings.hpp"
 #include "hir/main_bindings.hpp"
 #include "hir_conv/main_bindings.hpp"
@@ -27,6 +34,17 @@
 
 #include "expand/cfg.hpp"
 
+#ifdef _WIN32
+# define NOGDI  // Don't include GDI functions (defines some macros that collide with mrustc ones)
+# include <Windows.h>
+# include <Psapi.h>
+# undef min
+# undef max
+#else
+# include <sys/resource.h>
+# include <unistd.h>
+#endif
+
 // Hacky default target
 #ifdef _MSC_VER
 # if defined(_WIN64)
@@ -72,10 +90,11 @@
 # error "Unable to detect a suitable default target"
 #endif
 
-int g_debug_indent_level = 0;
+thread_local int g_debug_indent_level = 0;
 bool g_debug_enabled = true;
 ::std::string g_cur_phase;
 ::std::set< ::std::string>    g_debug_disable_map;
+unsigned int g_num_worker_threads = 1;
 
 void init_debug_list()
 {
@@ -154,15 +173,147 @@ bool debug_enabled_update() {
         return true;
     }
 }
-bool debug_enabled()
-{
-    return g_debug_enabled;
-}
 ::std::ostream& debug_output(int indent, const char* function)
 {
     return ::std::cout << g_cur_phase << "- " << RepeatLitStr { " ", indent } << function << ": ";
 }
 
+// --------------------------------------------------------------------
+// Per-phase resource usage (`--timings`)
+// --------------------------------------------------------------------
+namespace {
+    // Number of calls to the global allocator (used for per-phase allocation counts)
+    ::std::atomic<uint64_t>  g_allocation_count { 0 };
+
+    struct PhaseTiming
+    {
+        ::std::string   name;
+        double  wall_time;  // seconds
+        double  cpu_time;   // seconds
+        uint64_t    rss_peak_kb;
+        int64_t rss_delta_kb;
+        uint64_t    allocations;
+    };
+    ::std::vector<PhaseTiming>  g_phase_timings;
+    bool g_phase_timings_enabled = false;
+
+    /// Current resident set size, in KiB (0 if unavailable)
+    uint64_t get_rss_current_kb()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if( GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) )
+            return pmc.WorkingSetSize / 1024;
+        return 0;
+#elif defined(__linux__)
+        ::std::ifstream is("/proc/self/statm");
+        uint64_t    size = 0, resident = 0;
+        if( !(is >> size >> resident) )
+            return 0;
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+        // Only the peak is available elsewhere (via `getrusage`), so the current value is reported as 0
+        return 0;
+#endif
+    }
+    /// Peak resident set size of the process so far, in KiB
+    uint64_t get_rss_peak_kb()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if( GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) )
+            return pmc.PeakWorkingSetSize / 1024;
+        return 0;
+#else
+        struct rusage   ru;
+        if( getrusage(RUSAGE_SELF, &ru) != 0 )
+            return 0;
+# ifdef __APPLE__
+        return ru.ru_maxrss / 1024; // Bytes on OSX
+# else
+        return ru.ru_maxrss;    // KiB everywhere else
+# endif
+#endif
+    }
+
+    /// Write the collected phase timings to a file, format is picked from the extension (`.csv`, otherwise JSON)
+    void write_phase_timings(const ::std::string& filename)
+    {
+        ::std::ofstream os(filename);
+        if( !os.good() ) {
+            ::std::cerr << "Unable to open timings file '" << filename << "' for writing" << ::std::endl;
+            return ;
+        }
+        os << ::std::fixed << ::std::setprecision(6);
+        bool is_csv = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+        if( is_csv )
+        {
+            os << "phase,wall_s,cpu_s,rss_peak_kb,rss_delta_kb,allocations\n";
+            for(const auto& e : g_phase_timings)
+            {
+                os << "\"" << e.name << "\"," << e.wall_time << "," << e.cpu_time << "," << e.rss_peak_kb << "," << e.rss_delta_kb << "," << e.allocations << "\n";
+            }
+        }
+        else
+        {
+            os << "{\n";
+            os << "  \"phases\": [\n";
+            for(size_t i = 0; i < g_phase_timings.size(); i ++)
+            {
+                const auto& e = g_phase_timings[i];
+                os << "    {"
+                    << "\"phase\": \"" << e.name << "\", "
+                    << "\"wall_s\": " << e.wall_time << ", "
+                    << "\"cpu_s\": " << e.cpu_time << ", "
+                    << "\"rss_peak_kb\": " << e.rss_peak_kb << ", "
+                    << "\"rss_delta_kb\": " << e.rss_delta_kb << ", "
+                    << "\"allocations\": " << e.allocations
+                    << "}" << (i + 1 == g_phase_timings.size() ? "" : ",") << "\n";
+            }
+            os << "  ]\n";
+            os << "}\n";
+        }
+    }
+}
+
+// Replacements for the global allocator, counting allocations when `--timings` is enabled
+// - All of the plain/array and sized forms are replaced, so each `new` is paired with the matching `delete`
+// - The nothrow forms forward to these
+namespace {
+    void* counted_alloc(size_t size)
+    {
+        if( g_phase_timings_enabled )
+            g_allocation_count.fetch_add(1, ::std::memory_order_relaxed);
+        if( void* rv = ::std::malloc(size ? size : 1) )
+            return rv;
+        throw ::std::bad_alloc();
+    }
+}
+void* operator new(size_t size)
+{
+    return counted_alloc(size);
+}
+void* operator new[](size_t size)
+{
+    return counted_alloc(size);
+}
+void operator delete(void* ptr) noexcept
+{
+    ::std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept
+{
+    ::std::free(ptr);
+}
+void operator delete(void* ptr, size_t ) noexcept
+{
+    ::std::free(ptr);
+}
+void operator delete[](void* ptr, size_t ) noexcept
+{
+    ::std::free(ptr);
+}
+
 struct ProgramParams
 {
     enum eLastStage {
@@ -181,13 +332,21 @@ struct ProgramParams
     ::std::string   target = DEFAULT_TARGET_NAME;
 
     ::std::string   emit_depfile;
+    ::std::string   timings_file;
+    bool show_stats = false;
+    ::HIR::serialise::Compression   hir_compression = ::HIR::serialise::Compression::ZlibBest;
 
     ::AST::Crate::Type  crate_type = ::AST::Crate::Type::Unknown;
     ::std::string   crate_name;
     ::std::string   crate_name_suffix;
 
     unsigned opt_level = 0;
+    unsigned num_threads = 1;
     bool emit_debug_info = false;
+    bool lto = false;
+    bool profile_generate = false;
+    ::std::string   profile_generate_dir;
+    ::std::string   profile_use_dir;
 
     bool test_harness = false;
 
@@ -205,6 +364,8 @@ struct ProgramParams
     struct {
         ::std::string   codegen_type;
         ::std::string   emit_build_command;
+        unsigned int    codegen_units = 1;
+        ::std::string   mono_cache_dir;
     } codegen;
 
     ProgramParams(int argc, char *argv[]);
@@ -217,12 +378,34 @@ Rv CompilePhase(const char *name, Fcn f) {
     ::std::cout << name << ": V V V" << ::std::endl;
     g_cur_phase = name;
     g_debug_enabled = debug_enabled_update();
+    PhaseTiming timing;
+    uint64_t    start_rss = 0;
+    uint64_t    start_allocs = 0;
+    if( g_phase_timings_enabled ) {
+        start_rss = get_rss_current_kb();
+        start_allocs = g_allocation_count.load(::std::memory_order_relaxed);
+    }
+    auto start_wall = ::std::chrono::steady_clock::now();
     auto start = clock();
     auto rv = f();
     auto end = clock();
+    auto end_wall = ::std::chrono::steady_clock::now();
     g_cur_phase = "";
     g_debug_enabled = debug_enabled_update();
 
+    if( g_phase_timings_enabled ) {
+        timing.name = name;
+        timing.wall_time = ::std::chrono::duration<double>(end_wall - start_wall).count();
+        timing.cpu_time = static_cast<double>(end - start) / static_cast<double>(CLOCKS_PER_SEC);
+        timing.rss_peak_kb = get_rss_peak_kb();
+        timing.rss_delta_kb = static_cast<int64_t>(get_rss_current_kb()) - static_cast<int64_t>(start_rss);
+        timing.allocations = g_allocation_count.load(::std::memory_order_relaxed) - start_allocs;
+        g_phase_timings.push_back(mv$(timing));
+    }
+    if( Stats::g_enabled ) {
+        Stats::end_phase(name);
+    }
+
     ::std::cout <<"(" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(end - start) / static_cast<double>(CLOCKS_PER_SEC) << " s) ";
     ::std::cout << name << ": DONE";
     ::std::cout << ::std::endl;
@@ -233,11 +416,45 @@ void CompilePhaseV(const char *name, Fcn f) {
     CompilePhase<int>(name, [&]() { f(); return 0; });
 }
 
-/// main!
-int main(int argc, char *argv[])
+/// Write a path to a depfile, escaped as make expects (so ones containing spaces are kept intact)
+static void write_make_escaped(::std::ostream& os, const ::std::string& path)
+{
+    for(char c : path)
+    {
+        switch(c)
+        {
+        case ' ':
+        case '#':   os << '\\' << c;  break;
+        case '$':   os << "$$";  break;
+        default:    os << c;    break;
+        }
+    }
+}
+/// Write (space-prefixed) the source files of a module and all of its child modules
+static void write_module_files(::std::ostream& os, const ::AST::Module& mod)
+{
+    if( mod.m_file_info.path != "!" && mod.m_file_info.path.back() != '/' ) {
+        os << " "; write_make_escaped(os, mod.m_file_info.path);
+    }
+    // TODO: Should we check anon modules?
+    for(const auto& i : mod.items()) {
+        if(i.data.is_Module()) {
+            write_module_files(os, i.data.as_Module());
+        }
+    }
+}
+
+/// Run a single compilation (the entire normal `mrustc` invocation)
+static int compile_main(int argc, char *argv[])
 {
     init_debug_list();
     ProgramParams   params(argc, argv);
+    g_phase_timings_enabled = (params.timings_file != "");
+    Stats::g_enabled = params.show_stats;
+    if( Stats::g_enabled ) {
+        Stats::begin();
+    }
+    g_num_worker_threads = params.num_threads;
 
     // Set up cfg values
     Cfg_SetValue("rust_compiler", "mrustc");
@@ -425,33 +642,22 @@ int main(int argc, char *argv[])
         if( params.emit_depfile != "" )
         {
             ::std::ofstream of { params.emit_depfile };
-            of << params.outfile << ":";
+            write_make_escaped(of, params.outfile);
+            of << ":";
+            // - The crate root (the root module's path is its directory)
+            of << " "; write_make_escaped(of, params.infile);
             // - Iterate all loaded files for modules
-            struct H {
-                ::std::ofstream& of;
-                H(::std::ofstream& of): of(of) {}
-                void visit_module(::AST::Module& mod) {
-                    if( mod.m_file_info.path != "!" && mod.m_file_info.path.back() != '/' ) {
-                        of << " " << mod.m_file_info.path;
-                    }
-                    // TODO: Should we check anon modules?
-                    //for(auto& amod : mod.anon_mods()) {
-                    //    this->visit_module(*amod);
-                    //}
-                    for(auto& i : mod.items()) {
-                        if(i.data.is_Module()) {
-                            this->visit_module(i.data.as_Module());
-                        }
-                    }
-                }
-            };
-            H(of).visit_module(crate.m_root_module);
+            write_module_files(of, crate.m_root_module);
             // - Iterate all loaded crates files
             for(const auto& ec : crate.m_extern_crates)
             {
-                of << " " << ec.second.m_filename;
+                of << " "; write_make_escaped(of, ec.second.m_filename);
             }
             // - Iterate all extra files (include! and friends)
+            for(const auto& f : crate.m_extra_files)
+            {
+                of << " "; write_make_escaped(of, f);
+            }
         }
 
         // Resolve names to be absolute names (include references to the relevant struct/global/function)
@@ -625,6 +831,8 @@ int main(int argc, char *argv[])
         trans_opt.mode = params.codegen.codegen_type == "" ? "c" : params.codegen.codegen_type;
         trans_opt.build_command_file = params.codegen.emit_build_command;
         trans_opt.opt_level = params.opt_level;
+        trans_opt.codegen_units = params.codegen.codegen_units;
+        trans_opt.mono_cache_dir = params.codegen.mono_cache_dir;
         for(const char* libdir : params.lib_search_dirs ) {
             // Store these paths for use in final linking.
             hir_crate->m_link_paths.push_back( libdir );
@@ -633,6 +841,10 @@ int main(int argc, char *argv[])
             hir_crate->m_ext_libs.push_back(::HIR::ExternLibrary { libname });
         }
         trans_opt.emit_debug_info = params.emit_debug_info;
+        trans_opt.lto = params.lto;
+        trans_opt.profile_generate = params.profile_generate;
+        trans_opt.profile_generate_dir = params.profile_generate_dir;
+        trans_opt.profile_use_dir = params.profile_use_dir;
 
         // Generate code for non-generic public items (if requested)
         if( params.test_harness )
@@ -649,7 +861,7 @@ int main(int argc, char *argv[])
             #if 1
             // Generate a .o
             TransList   items = CompilePhase<TransList>("Trans Enumerate", [&]() { return Trans_Enumerate_Public(*hir_crate); });
-            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items); });
+            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items, trans_opt); });
             CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items); });
             //CompilePhaseV("Trans Enumerate Cleanup", [&]() { Trans_Enumerate_Cleanup(*hir_crate, items); });
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile + ".o", trans_opt, *hir_crate, items, false); });
@@ -658,7 +870,7 @@ int main(int argc, char *argv[])
             // Save a loadable HIR dump
             CompilePhaseV("HIR Serialise", [&]() {
                 //HIR_Serialise(params.outfile + ".meta", *hir_crate);
-                HIR_Serialise(params.outfile, *hir_crate);
+                HIR_Serialise(params.outfile, *hir_crate, params.hir_compression);
                 });
 
             // Link metatdata and object into a .rlib
@@ -667,12 +879,12 @@ int main(int argc, char *argv[])
             #if 1
             // Generate a .o
             TransList   items = CompilePhase<TransList>("Trans Enumerate", [&]() { return Trans_Enumerate_Public(*hir_crate); });
-            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items); });
+            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items, trans_opt); });
             CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items); });
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile + ".o", trans_opt, *hir_crate, items, false); });
             #endif
             // Save a loadable HIR dump
-            CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(params.outfile, *hir_crate); });
+            CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(params.outfile, *hir_crate, params.hir_compression); });
 
             // Generate a .so/.dll
             // TODO: Codegen and include the metadata in a non-loadable segment
@@ -685,24 +897,24 @@ int main(int argc, char *argv[])
             // Can just emit the metadata and do miri?
             // - Requires MIR for EVERYTHING, not feasable.
             TransList items = CompilePhase<TransList>("Trans Enumerate", [&]() { return Trans_Enumerate_Public(*hir_crate); });
-            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items); });
+            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items, trans_opt); });
             CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items); });
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile + ".o", trans_opt, *hir_crate, items, false); });
 
             TransList items2 = CompilePhase<TransList>("Trans Enumerate", [&]() { return Trans_Enumerate_Main(*hir_crate); });
-            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items2); });
+            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items2, trans_opt); });
             CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items2); });
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile + "-plugin", trans_opt, *hir_crate, items2, true); });
 
             hir_crate->m_lang_items.clear();    // Make sure that we're not exporting any lang items
-            CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(params.outfile, *hir_crate); });
+            CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(params.outfile, *hir_crate, params.hir_compression); });
             break; }
         case ::AST::Crate::Type::Executable:
             // Generate a binary
             // - Enumerate items for translation
             TransList items = CompilePhase<TransList>("Trans Enumerate", [&]() { return Trans_Enumerate_Main(*hir_crate); });
             // - Monomorphise
-            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items); });
+            CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items, trans_opt); });
             CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items); });
             // - Perform codegen
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile, trans_opt, *hir_crate, items, true); });
@@ -710,6 +922,15 @@ int main(int argc, char *argv[])
         }
     }
     catch(unsigned int) {}
+
+    if( params.timings_file != "" )
+    {
+        write_phase_timings(params.timings_file);
+    }
+    if( params.show_stats )
+    {
+        Stats::print_report(::std::cout);
+    }
     //catch(const CompileError::Base& e)
     //{
     //    ::std::cerr << "Parser Error: " << e.what() << ::std::endl;
@@ -729,6 +950,21 @@ int main(int argc, char *argv[])
     return 0;
 }
 
+/// main!
+int main(int argc, char *argv[])
+{
+    // `--compile-server` must be the only argument, jobs are then read from stdin
+    if( argc == 2 && strcmp(argv[1], "--compile-server") == 0 )
+    {
+        // The server itself only loads crates, so use the debug settings for that phase
+        init_debug_list();
+        g_cur_phase = "LoadCrates";
+        g_debug_enabled = debug_enabled_update();
+        return CompileServer_Run(argv[0], compile_main);
+    }
+    return compile_main(argc, argv);
+}
+
 ProgramParams::ProgramParams(int argc, char *argv[])
 {
     // Hacky command-line parsing
@@ -778,6 +1014,26 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     this->libraries.push_back( arg+1 );
                 }
                 continue ;
+            case 'j': {
+                const char* count_str;
+                if( arg[1] == '\0' ) {
+                    if( i == argc - 1 ) {
+                        ::std::cerr << "Option " << arg << " requires an argument" << ::std::endl;
+                        exit(1);
+                    }
+                    count_str = argv[++i];
+                }
+                else {
+                    count_str = arg+1;
+                }
+                char* end;
+                unsigned long count = ::std::strtoul(count_str, &end, 10);
+                if( *end != '\0' || count == 0 ) {
+                    ::std::cerr << "Option -j requires a positive integer, got '" << count_str << "'" << ::std::endl;
+                    exit(1);
+                }
+                this->num_threads = static_cast<unsigned>(count);
+                } continue;
             case 'C': {
                 ::std::string optname;
                 ::std::string optval;
@@ -821,6 +1077,25 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     get_optval();
                     this->emit_depfile = optval;
                 }
+                // `-C hir-compression=<none|fast|best>` - Compression of the emitted crate metadata
+                else if( optname == "hir-compression" ) {
+                    get_optval();
+                    if( optval == "none" )
+                        this->hir_compression = ::HIR::serialise::Compression::None;
+                    else if( optval == "fast" )
+                        this->hir_compression = ::HIR::serialise::Compression::ZlibFast;
+                    else if( optval == "best" )
+                        this->hir_compression = ::HIR::serialise::Compression::ZlibBest;
+                    else {
+                        ::std::cerr << "Unknown argument to -C hir-compression - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                }
+                // `-C mono-cache=<dir>` - Reuse monomorphised function bodies from (and save them to) this directory
+                else if( optname == "mono-cache" ) {
+                    get_optval();
+                    this->codegen.mono_cache_dir = optval;
+                }
                 else {
                     ::std::cerr << "Unknown codegen option: '" << optname << "'" << ::std::endl;
                     exit(1);
@@ -1041,6 +1316,48 @@ ProgramParams::ProgramParams(int argc, char *argv[])
             else if( strcmp(arg, "--test") == 0 ) {
                 this->test_harness = true;
             }
+            // `--timings=<file>`   - Write a per-phase time/memory report (CSV if the file ends in `.csv`, JSON otherwise)
+            else if( strncmp(arg, "--timings=", 10) == 0 ) {
+                this->timings_file = arg + 10;
+                if( this->timings_file == "" ) {
+                    ::std::cerr << "Flag --timings requires a filename" << ::std::endl;
+                    exit(1);
+                }
+            }
+            // `--stats` - Print per-phase call counts (and sampled times) of hot functions
+            else if( strcmp(arg, "--stats") == 0 ) {
+                this->show_stats = true;
+            }
+            // `--lto` - Link-time optimisation (pass to every crate in the build, so they can be optimised together)
+            else if( strcmp(arg, "--lto") == 0 ) {
+                this->lto = true;
+            }
+            // `--profile-generate[=<dir>]` - Build instrumented code, for profile-guided optimisation
+            else if( strcmp(arg, "--profile-generate") == 0 ) {
+                this->profile_generate = true;
+            }
+            else if( strncmp(arg, "--profile-generate=", 19) == 0 ) {
+                this->profile_generate = true;
+                this->profile_generate_dir = arg + 19;
+            }
+            // `--profile-use=<dir>` - Optimise using profiles recorded by a `--profile-generate` build
+            else if( strncmp(arg, "--profile-use=", 14) == 0 ) {
+                this->profile_use_dir = arg + 14;
+                if( this->profile_use_dir == "" ) {
+                    ::std::cerr << "Flag --profile-use requires a directory" << ::std::endl;
+                    exit(1);
+                }
+            }
+            // `--codegen-units=<count>` - Split the generated C into this many files, compiled concurrently
+            else if( strncmp(arg, "--codegen-units=", 16) == 0 ) {
+                char* end;
+                unsigned long count = ::std::strtoul(arg + 16, &end, 10);
+                if( arg[16] == '\0' || *end != '\0' || count == 0 ) {
+                    ::std::cerr << "Flag --codegen-units requires a positive integer, got '" << (arg + 16) << "'" << ::std::endl;
+                    exit(1);
+                }
+                this->codegen.codegen_units = static_cast<unsigned>(count);
+            }
             else {
                 ::std::cerr << "Unknown option '" << arg << "'" << ::std::endl;
                 exit(1);
@@ -1048,6 +1365,18 @@ ProgramParams::ProgramParams(int argc, char *argv[])
         }
     }
 
+    if( this->profile_generate && this->profile_use_dir != "" )
+    {
+        ::std::cerr << "--profile-generate and --profile-use can't be used together" << ::std::endl;
+        exit(1);
+    }
+    // Linking the split units with MSVC would need `lib.exe`, which isn't supported
+    if( this->codegen.codegen_units > 1 && Target_GetCodegenMode(this->target) == CodegenMode::Msvc )
+    {
+        ::std::cerr << "--codegen-units is not supported with the MSVC backend (target " << this->target << ")" << ::std::endl;
+        exit(1);
+    }
+
     if (this->infile == "")
     {
         ::std::cerr << "No input file passed" << ::std::endl;
@@ -1064,6 +1393,7 @@ void ProgramParams::show_help() const
         "-o <filename>      : Write compiler output (library or executable) to this file\n"
         "-O                 : Enable optimistion\n"
         "-g                 : Emit debugging information\n"
+        "-j <count>         : Use up to <count> threads for parallel phases\n"
         "--out-dir <dir>    : Specify the output directory (alternative to `-o`)\n"
         "--extern <crate>=<path>\n"
         "                   : Specify the path for a given crate (instead of searching for it)\n"
@@ -1074,8 +1404,17 @@ void ProgramParams::show_help() const
         "--cfg flag=\"val\"   : Set a string #[cfg]/cfg! flag\n"
         "--target <name>    : Compile code for the given target\n"
         "--test             : Generate a unit test executable\n"
+        "--timings=<file>   : Write per-phase wall/CPU time, memory and allocation counts to a JSON (or .csv) file\n"
+        "--stats            : Print per-phase call counts and estimated times of hot compiler functions\n"
+        "--codegen-units=<count>\n"
+        "                   : Split generated C code into <count> files, compiled in parallel (up to -j at once, not supported with MSVC)\n"
+        "--lto              : Enable link-time optimisation (for cross-crate inlining, use for all crates in a build)\n"
+        "--profile-generate[=<dir>]\n"
+        "                   : Build instrumented code that records an execution profile (in <dir>)\n"
+        "--profile-use=<dir>: Optimise using profiles recorded by a `--profile-generate` build\n"
         "-C <option>        : Code-generation options\n"
         "-Z <option>        : Debugging/experiemental options\n"
+        "--compile-server   : Run compile jobs read from stdin, keeping loaded crates between jobs (see compile_server.cpp)\n"
         ;
 }
 
@@ -28,7 +28,7 @@ namespace {
             else
             {
                 auto vtable_ty_spath = trait_path.m_path.m_path;
-                vtable_ty_spath.m_components.back() += "#vtable";
+                vtable_ty_spath.m_components.back() = vtable_ty_spath.m_components.back() + "#vtable";
                 const auto& vtable_ref = state.m_resolve.m_crate.get_struct_by_path(state.sp, vtable_ty_spath);
                 // Copy the param set from the trait in the trait object
                 ::HIR::PathParams   vtable_params = trait_path.m_path.m_params.clone();
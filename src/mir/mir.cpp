@@ -671,3 +671,97 @@ namespace MIR {
     throw "";
 }
 
+
+::MIR::Function MIR::Function::clone() const
+{
+    ::MIR::Function rv;
+    rv.locals.reserve(this->locals.size());
+    for(const auto& ty : this->locals)
+        rv.locals.push_back( ty.clone() );
+    rv.drop_flags = this->drop_flags;
+
+    auto clone_params = [](const ::std::vector<::MIR::Param>& params) {
+        ::std::vector<::MIR::Param> rv;
+        rv.reserve(params.size());
+        for(const auto& p : params)
+            rv.push_back( p.clone() );
+        return rv;
+        };
+    auto clone_asm_lvalues = [](const ::std::vector< ::std::pair<::std::string,::MIR::LValue> >& vals) {
+        ::std::vector< ::std::pair<::std::string,::MIR::LValue> >   rv;
+        rv.reserve(vals.size());
+        for(const auto& v : vals)
+            rv.push_back(::std::make_pair( v.first, v.second.clone() ));
+        return rv;
+        };
+
+    rv.blocks.reserve(this->blocks.size());
+    for(const auto& bb : this->blocks)
+    {
+        ::MIR::BasicBlock   new_bb;
+        new_bb.statements.reserve(bb.statements.size());
+        for(const auto& stmt : bb.statements)
+        {
+            TU_MATCHA( (stmt), (se),
+            (Assign,
+                new_bb.statements.push_back(::MIR::Statement::make_Assign({ se.dst.clone(), se.src.clone() }));
+                ),
+            (Asm,
+                new_bb.statements.push_back(::MIR::Statement::make_Asm({ se.tpl, clone_asm_lvalues(se.outputs), clone_asm_lvalues(se.inputs), se.clobbers, se.flags }));
+                ),
+            (SetDropFlag,
+                new_bb.statements.push_back(::MIR::Statement::make_SetDropFlag({ se.idx, se.new_val, se.other }));
+                ),
+            (Drop,
+                new_bb.statements.push_back(::MIR::Statement::make_Drop({ se.kind, se.slot.clone(), se.flag_idx }));
+                ),
+            (ScopeEnd,
+                new_bb.statements.push_back(::MIR::Statement::make_ScopeEnd({ se.slots }));
+                )
+            )
+        }
+        TU_MATCHA( (bb.terminator), (te),
+        (Incomplete,
+            new_bb.terminator = ::MIR::Terminator::make_Incomplete({});
+            ),
+        (Return,
+            new_bb.terminator = ::MIR::Terminator::make_Return({});
+            ),
+        (Diverge,
+            new_bb.terminator = ::MIR::Terminator::make_Diverge({});
+            ),
+        (Goto,
+            new_bb.terminator = ::MIR::Terminator::make_Goto(te);
+            ),
+        (Panic,
+            new_bb.terminator = ::MIR::Terminator::make_Panic({ te.dst });
+            ),
+        (If,
+            new_bb.terminator = ::MIR::Terminator::make_If({ te.cond.clone(), te.bb0, te.bb1 });
+            ),
+        (Switch,
+            new_bb.terminator = ::MIR::Terminator::make_Switch({ te.val.clone(), te.targets });
+            ),
+        (SwitchValue,
+            new_bb.terminator = ::MIR::Terminator::make_SwitchValue({ te.val.clone(), te.def_target, te.targets, te.values.clone() });
+            ),
+        (Call,
+            ::MIR::CallTarget   fcn;
+            TU_MATCHA( (te.fcn), (fe),
+            (Value,
+                fcn = ::MIR::CallTarget::make_Value( fe.clone() );
+                ),
+            (Path,
+                fcn = ::MIR::CallTarget::make_Path( fe.clone() );
+                ),
+            (Intrinsic,
+                fcn = ::MIR::CallTarget::make_Intrinsic({ fe.name, fe.params.clone() });
+                )
+            )
+            new_bb.terminator = ::MIR::Terminator::make_Call({ te.ret_block, te.panic_block, te.ret_val.clone(), mv$(fcn), clone_params(te.args) });
+            )
+        )
+        rv.blocks.push_back( mv$(new_bb) );
+    }
+    return rv;
+}
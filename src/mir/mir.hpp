@@ -306,6 +306,8 @@ public:
     ::std::vector<bool> drop_flags;
 
     ::std::vector<BasicBlock>   blocks;
+
+    Function clone() const;
 };
 
 };
@@ -3,17 +3,74 @@
  * - By John Hodge (Mutabah/thePowersGang)
  *
  * mir/mir_ptr.cpp
- * - Destructor for MIR function pointers (cold path code)
+ * - Out-of-line parts of MIR function pointers (destruction and on-demand loading)
  */
 #include "mir_ptr.hpp"
 #include "mir.hpp"
+#include <mutex>
 
+struct MIR::FunctionPointer::LazyState
+{
+    ::std::mutex    lock;
+    ::std::function<::MIR::Function*()>   loader;
+    ::std::function<void(::MIR::Function&)> post_load;
+};
+
+::MIR::FunctionPointer MIR::FunctionPointer::new_lazy(::std::function<::MIR::Function*()> loader)
+{
+    FunctionPointer rv;
+    rv.m_lazy = new LazyState;
+    rv.m_lazy->loader = mv$(loader);
+    return rv;
+}
 
 void ::MIR::FunctionPointer::reset()
 {
-    if( this->ptr ) {
-        delete this->ptr;
+    if( auto* p = this->ptr.load() ) {
+        delete p;
         this->ptr = nullptr;
     }
+    if( this->m_lazy ) {
+        delete this->m_lazy;
+        this->m_lazy = nullptr;
+    }
+}
+::MIR::Function* ::MIR::FunctionPointer::release()
+{
+    auto* rv = this->get();
+    this->ptr = nullptr;
+    if( this->m_lazy ) {
+        delete this->m_lazy;
+        this->m_lazy = nullptr;
+    }
+    return rv;
 }
 
+void ::MIR::FunctionPointer::set_post_load(::std::function<void(::MIR::Function&)> cb)
+{
+    if( !this->m_lazy || this->ptr.load() ) {
+        cb(*this->get());
+        return ;
+    }
+    ::std::lock_guard<::std::mutex>  lh { this->m_lazy->lock };
+    if( auto* p = this->ptr.load() ) {
+        cb(*p);
+    }
+    else {
+        this->m_lazy->post_load = mv$(cb);
+    }
+}
+
+::MIR::Function* ::MIR::FunctionPointer::load() const
+{
+    ::std::lock_guard<::std::mutex>  lh { this->m_lazy->lock };
+    // Another thread may have loaded it while we waited for the lock
+    if( auto* p = this->ptr.load() )
+        return p;
+
+    auto* p = this->m_lazy->loader();
+    if( this->m_lazy->post_load )
+        this->m_lazy->post_load(*p);
+    this->ptr.store(p, ::std::memory_order_release);
+    return p;
+}
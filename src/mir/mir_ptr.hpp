@@ -6,6 +6,8 @@
  * - Pointer to a blob of MIR
  */
 #pragma once
+#include <atomic>
+#include <functional>
 
 
 namespace MIR {
@@ -14,30 +16,54 @@ class Function;
 
 class FunctionPointer
 {
-    ::MIR::Function*    ptr;
+    struct LazyState;
+
+    mutable ::std::atomic<::MIR::Function*>   ptr;
+    // Set if the MIR is loaded on first access (e.g. from extern crate metadata)
+    LazyState*  m_lazy;
 public:
-    FunctionPointer(): ptr(nullptr) {}
-    FunctionPointer(::MIR::Function* p): ptr(p) {}
-    FunctionPointer(FunctionPointer&& x): ptr(x.ptr) { x.ptr = nullptr; }
+    FunctionPointer(): ptr(nullptr), m_lazy(nullptr) {}
+    FunctionPointer(::MIR::Function* p): ptr(p), m_lazy(nullptr) {}
+    FunctionPointer(FunctionPointer&& x): ptr(x.ptr.load()), m_lazy(x.m_lazy) { x.ptr = nullptr; x.m_lazy = nullptr; }
+
+    /// Create a pointer that calls `loader` the first time the MIR is accessed
+    static FunctionPointer new_lazy(::std::function<::MIR::Function*()> loader);
 
     ~FunctionPointer() {
         reset();
     }
     FunctionPointer& operator=(FunctionPointer&& x) {
         reset();
-        ptr = x.ptr;
+        ptr = x.ptr.load();
+        m_lazy = x.m_lazy;
         x.ptr = nullptr;
+        x.m_lazy = nullptr;
         return *this;
     }
 
     void reset();
+    /// Release ownership of the (loaded) function
+    ::MIR::Function* release();
 
-    ::MIR::Function* operator->() { return ptr; }
-    ::MIR::Function& operator*() { return *ptr; }
-    const ::MIR::Function* operator->() const { return ptr; }
-    const ::MIR::Function& operator*() const { return *ptr; }
+    /// Returns false if the MIR is yet to be loaded
+    bool is_loaded() const { return ptr.load(::std::memory_order_acquire) != nullptr || m_lazy == nullptr; }
+    /// Register a callback to run on the MIR once it has been loaded (before any other access)
+    void set_post_load(::std::function<void(::MIR::Function&)> cb);
+
+    ::MIR::Function* get() const {
+        auto* p = ptr.load(::std::memory_order_acquire);
+        if( !p && m_lazy )
+            p = load();
+        return p;
+    }
+    ::MIR::Function* operator->() { return get(); }
+    ::MIR::Function& operator*() { return *get(); }
+    const ::MIR::Function* operator->() const { return get(); }
+    const ::MIR::Function& operator*() const { return *get(); }
 
-    operator bool() const { return ptr != nullptr; }
+    operator bool() const { return ptr.load(::std::memory_order_relaxed) != nullptr || m_lazy != nullptr; }
+private:
+    ::MIR::Function* load() const;
 };
 
 }
@@ -15,6 +15,12 @@
 #include <mir/visit_crate_mir.hpp>
 #include <algorithm>
 #include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <parallel.hpp>
 #include <trans/target.hpp>
 #include <trans/trans_list.hpp> // Note: This is included for inlining after enumeration and monomorph
 
@@ -31,6 +37,59 @@
 #define CHECK_AFTER_DONE    2   // 1 = Check before GC, 2 = check before and after GC
 
 namespace {
+    /// Bodies being optimised by `MIR_OptimiseCrate` on worker threads
+    ///
+    /// A serial run inlines earlier bodies after they're optimised, and later bodies as they were before the pass. To
+    /// match that: inlining an earlier body waits for it to complete, and later bodies are read from a snapshot (they
+    /// may be mid-modification on another thread).
+    class ParallelOptimiseState
+    {
+        ::std::unordered_map<const ::MIR::Function*, size_t>   m_body_indexes;
+        // Pre-pass copies of bodies small enough to be inlined
+        ::std::vector<::std::unique_ptr<::MIR::Function>>   m_snapshots;
+        ::std::vector<bool> m_complete;
+        ::std::mutex    m_lock;
+        ::std::condition_variable   m_cv;
+    public:
+        ParallelOptimiseState(const ::std::vector<::MIR::Function*>& bodies):
+            m_complete( bodies.size() )
+        {
+            for(size_t i = 0; i < bodies.size(); i ++)
+            {
+                const auto& fcn = *bodies[i];
+                m_body_indexes.insert(::std::make_pair( &fcn, i ));
+                // NOTE: Superset of the shapes accepted by `can_inline`
+                if( fcn.blocks.size() <= 3 || fcn.blocks[0].terminator.is_Switch() )
+                    m_snapshots.push_back( box$(fcn.clone()) );
+                else
+                    m_snapshots.push_back( nullptr );
+            }
+        }
+
+        /// Get the version of `fcn` that job `cur_job` should inline (nullptr if it shouldn't be inlined)
+        const ::MIR::Function* get_inline_source(size_t cur_job, const ::MIR::Function* fcn)
+        {
+            auto it = m_body_indexes.find(fcn);
+            if( it == m_body_indexes.end() )
+                return fcn;
+            if( it->second > cur_job )
+                return m_snapshots[it->second].get();
+            ::std::unique_lock<::std::mutex>    lh { m_lock };
+            m_cv.wait(lh, [&]{ return m_complete[it->second]; });
+            return fcn;
+        }
+        void mark_complete(size_t job)
+        {
+            {
+                ::std::lock_guard<::std::mutex> lh { m_lock };
+                m_complete[job] = true;
+            }
+            m_cv.notify_all();
+        }
+    };
+    ParallelOptimiseState*  g_parallel_state = nullptr;
+    thread_local size_t t_parallel_cur_job;
+
     ::MIR::BasicBlockId get_new_target(const ::MIR::TypeResolve& state, ::MIR::BasicBlockId bb)
     {
         const auto& target = state.get_block(bb);
@@ -1263,6 +1322,15 @@ bool MIR_Optimise_Inlining(::MIR::TypeResolve& state, ::MIR::Function& fcn, bool
                 DEBUG("Can't inline - recursion");
                 continue ;
             }
+            if( g_parallel_state )
+            {
+                called_mir = g_parallel_state->get_inline_source(t_parallel_cur_job, called_mir);
+                if( !called_mir )
+                {
+                    DEBUG("Can't inline - no snapshot of later body");
+                    continue ;
+                }
+            }
 
             // Check the size of the target function.
             // Inline IF:
@@ -3703,57 +3771,158 @@ void MIR_SortBlocks(const StaticTraitResolve& resolve, const ::HIR::ItemPath& pa
 
 void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
 {
-    ::MIR::OuterVisitor ov { crate, [do_minimal_optimisation](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
+    // Function bodies are optimised independently, so collect them first and then run them on the worker pool.
+    struct Job {
+        ::std::string   path;
+        ::HIR::GenericParams*   impl_generics;
+        ::HIR::GenericParams*   item_generics;
+        ::MIR::Function*    fcn;
+        const ::HIR::Function::args_t*  args;
+        ::HIR::TypeRef  ret_type;
+    };
+    static const ::HIR::Function::args_t  empty_args;
+    ::std::vector<Job>  jobs;
+    ::MIR::OuterVisitor ov { crate, [&](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
         {
             if( ! dynamic_cast<::HIR::ExprNode_Block*>(expr.get()) ) {
                 return ;
             }
-            if( do_minimal_optimisation ) {
-                MIR_OptimiseMin(res, p, *expr.m_mir, args, ty);
-            }
-            else {
-                MIR_Optimise(res, p, *expr.m_mir, args, ty);
-            }
+            // NOTE: `args` is only non-empty when it refers to a function's argument list (which outlives this pass)
+            jobs.push_back(Job { FMT(p), res.m_impl_generics, res.m_item_generics, &*expr.m_mir, args.empty() ? &empty_args : &args, ty.clone() });
         }
         };
     ov.visit_crate(crate);
+
+    unsigned int n_workers = parallel_worker_count(jobs.size());
+    ::std::unique_ptr<ParallelOptimiseState>    parallel_state;
+    if( n_workers > 1 )
+    {
+        ::std::vector<::MIR::Function*> bodies;
+        for(const auto& job : jobs)
+            bodies.push_back(job.fcn);
+        parallel_state.reset(new ParallelOptimiseState(bodies));
+        g_parallel_state = parallel_state.get();
+    }
+
+    // Each worker needs its own resolver (it holds the current generics and a cache)
+    ::std::vector<::std::unique_ptr<StaticTraitResolve>>    resolvers;
+    for(unsigned int i = 0; i < n_workers; i ++)
+        resolvers.push_back( ::std::unique_ptr<StaticTraitResolve>(new StaticTraitResolve(crate)) );
+
+    parallel_for(jobs.size(), [&](unsigned int worker_idx, size_t job_idx) {
+        const auto& job = jobs[job_idx];
+        auto& res = *resolvers[worker_idx];
+        res.set_generics(job.impl_generics, job.item_generics);
+        // Always release waiters (even if this job throws)
+        struct CompleteGuard {
+            size_t idx;
+            ~CompleteGuard() { if( g_parallel_state ) g_parallel_state->mark_complete(idx); }
+        } _cg { job_idx };
+        t_parallel_cur_job = job_idx;
+        ::HIR::ItemPath ip(job.path);
+        if( do_minimal_optimisation ) {
+            MIR_OptimiseMin(res, ip, *job.fcn, *job.args, job.ret_type);
+        }
+        else {
+            MIR_Optimise(res, ip, *job.fcn, *job.args, job.ret_type);
+        }
+        });
+
+    g_parallel_state = nullptr;
 }
 
 void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list)
 {
-    ::StaticTraitResolve    resolve { crate };
+    struct Job {
+        const ::HIR::Path*  path;
+        ::MIR::Function*    fcn;
+        const ::HIR::Function::args_t*  args;
+        const ::HIR::TypeRef*   ret_type;
+    };
+    // NOTE: Sorted, the result of inlining depends on the order that functions are processed
+    ::std::vector<Job>  jobs;
+    for(const auto* fcn_ent_ptr : sorted_entries(list.m_functions))
+    {
+        const auto& fcn_ent = *fcn_ent_ptr;
+        auto& hir_fcn = *const_cast<::HIR::Function*>(fcn_ent.second->ptr);
+        auto& mono_fcn = fcn_ent.second->monomorphised;
+        if( mono_fcn.code )
+        {
+            jobs.push_back(Job { &fcn_ent.first, &*mono_fcn.code, &mono_fcn.arg_tys, &mono_fcn.ret_ty });
+        }
+        else if( hir_fcn.m_code.m_mir )
+        {
+            jobs.push_back(Job { &fcn_ent.first, &*hir_fcn.m_code.m_mir, &hir_fcn.m_args, &hir_fcn.m_return });
+        }
+        else
+        {
+            // Extern, no optimisations
+        }
+    }
 
-    bool did_inline_on_pass;
+    unsigned int n_workers = parallel_worker_count(jobs.size());
+    // If two entries share a body (e.g. the same function reached via two paths), they can't be run concurrently
+    {
+        ::std::unordered_set<const ::MIR::Function*>    seen;
+        for(const auto& job : jobs)
+        {
+            if( !seen.insert(job.fcn).second )
+            {
+                n_workers = 1;
+                break;
+            }
+        }
+    }
+
+    // Each worker needs its own resolver (it holds a cache)
+    ::std::vector<::std::unique_ptr<StaticTraitResolve>>    resolvers;
+    for(unsigned int i = 0; i < n_workers; i ++)
+        resolvers.push_back( ::std::unique_ptr<StaticTraitResolve>(new StaticTraitResolve(crate)) );
 
+    ::std::atomic<bool> did_inline_on_pass;
     size_t  MAX_ITERATIONS = 5; // TODO: Tune this.
     size_t  num_iterations = 0;
     do
     {
         did_inline_on_pass = false;
 
-        for(auto& fcn_ent : list.m_functions)
+        // Same scheme as `MIR_OptimiseCrate`, the result matches a serial run
+        ::std::unique_ptr<ParallelOptimiseState>    parallel_state;
+        if( n_workers > 1 )
         {
-            const auto& path = fcn_ent.first;
-            //const auto& pp = fcn_ent.second->pp;
-            auto& hir_fcn = *const_cast<::HIR::Function*>(fcn_ent.second->ptr);
-            auto& mono_fcn = fcn_ent.second->monomorphised;
+            ::std::vector<::MIR::Function*> bodies;
+            for(const auto& job : jobs)
+                bodies.push_back(job.fcn);
+            parallel_state.reset(new ParallelOptimiseState(bodies));
+            g_parallel_state = parallel_state.get();
+        }
 
-            ::std::string s = FMT(path);
-            ::HIR::ItemPath ip(s);
+        auto run_job = [&](unsigned int worker_idx, size_t job_idx) {
+            const auto& job = jobs[job_idx];
+            struct CompleteGuard {
+                size_t idx;
+                ~CompleteGuard() { if( g_parallel_state ) g_parallel_state->mark_complete(idx); }
+            } _cg { job_idx };
+            t_parallel_cur_job = job_idx;
 
-            if( mono_fcn.code )
-            {
-                did_inline_on_pass |= MIR_OptimiseInline(resolve, ip, *mono_fcn.code, mono_fcn.arg_tys, mono_fcn.ret_ty, list);
-            }
-            else if( hir_fcn.m_code.m_mir)
-            {
-                did_inline_on_pass |= MIR_OptimiseInline(resolve, ip, *hir_fcn.m_code.m_mir, hir_fcn.m_args, hir_fcn.m_return, list);
-            }
-            else
+            ::std::string s = FMT(*job.path);
+            ::HIR::ItemPath ip(s);
+            if( MIR_OptimiseInline(*resolvers[worker_idx], ip, *job.fcn, *job.args, *job.ret_type, list) )
             {
-                // Extern, no optimisations
+                did_inline_on_pass = true;
             }
+            };
+        if( n_workers > 1 )
+        {
+            parallel_for(jobs.size(), run_job);
+        }
+        else
+        {
+            for(size_t i = 0; i < jobs.size(); i ++)
+                run_job(0, i);
         }
+        g_parallel_state = nullptr;
+        num_iterations ++;
     } while( did_inline_on_pass && num_iterations < MAX_ITERATIONS );
 
     if( did_inline_on_pass )
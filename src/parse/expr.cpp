@@ -1320,6 +1320,10 @@ TokenTree Parse_TT(TokenStream& lex, bool unwrapped)
         return rv;
     }
 
+    // Substituted `tt` captures are taken whole, instead of rebuilding them token-by-token
+    if( !unwrapped && lex.take_tt(rv) )
+        return rv;
+
     ::std::vector<TokenTree>   items;
     if( !unwrapped )
         items.push_back( TokenTree(lex.getHygiene(), mv$(tok)) );
@@ -59,7 +59,8 @@ InterpolatedFragment::InterpolatedFragment(::AST::Named<::AST::Item> v):
 }
 InterpolatedFragment::InterpolatedFragment(TokenTree v):
     m_type( InterpolatedFragment::TT ),
-    m_ptr( new TokenTree(mv$(v)) )
+    // Shared, so that substituting the capture (or passing it on to another macro) doesn't copy it
+    m_ptr( new TokenTree( TokenTree::make_shared(mv$(v)) ) )
 {
 }
 InterpolatedFragment::InterpolatedFragment(AST::Path v):
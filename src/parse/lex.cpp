@@ -15,24 +15,99 @@
 #include <typeinfo>
 #include <algorithm>    // std::count
 #include <cctype>
+#include <cstring>  // memcpy
+#include <fstream>
+#include <vector>
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
 //#define TRACE_CHARS
 //#define TRACE_RAW_TOKENS
 
+namespace {
+    // Character classes (ASCII only) for the lexer's fast paths
+    struct CharClasses
+    {
+        bool ident[128];
+        bool space[128];    // Excludes newline (which is its own token)
+        bool digit[128];    // Decimal digits and the `_` separator
+
+        CharClasses()
+        {
+            for(int c = 0; c < 128; c ++)
+            {
+                ident[c] = ::std::isalnum(c) || c == '_';
+                space[c] = c == ' ' || c == '\t' || c == '\r' || c == 0xC;
+                digit[c] = ('0' <= c && c <= '9') || c == '_';
+            }
+        }
+    };
+    const CharClasses   s_char_classes;
+
+    // Word-at-a-time byte tests (true if any byte in the word matches)
+    const uint64_t  WORD_ONES = 0x0101010101010101ull;
+    const uint64_t  WORD_HIGHS = 0x8080808080808080ull;
+    inline bool word_has_zero(uint64_t w) {
+        return ((w - WORD_ONES) & ~w & WORD_HIGHS) != 0;
+    }
+    inline bool word_has_byte(uint64_t w, char b) {
+        return word_has_zero(w ^ (WORD_ONES * static_cast<uint8_t>(b)));
+    }
+}
+
 Lexer::Lexer(const ::std::string& filename):
     m_path(filename.c_str()),
     m_line(1),
     m_line_ofs(0),
-    m_istream(filename.c_str()),
+    m_data(nullptr),
+    m_data_len(0),
+    m_data_pos(0),
     m_last_char_valid(false),
     m_hygiene( Ident::Hygiene::new_scope() )
 {
-    if( !m_istream.is_open() )
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if( fd < 0 )
     {
         throw ::std::runtime_error("Unable to open file '" + filename + "'");
     }
+    struct stat st;
+    void* base = MAP_FAILED;
+    size_t size = 0;
+    if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 )
+    {
+        size = static_cast<size_t>(st.st_size);
+        base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if( base != MAP_FAILED )
+    {
+        m_data_owner = ::std::shared_ptr<const void>(base, [size](const void* p){ munmap(const_cast<void*>(p), size); });
+        m_data = static_cast<const char*>(base);
+        m_data_len = size;
+    }
+    else
+#endif
+    {
+        // No mapping available (or an empty/special file), read the whole file into memory instead
+        ::std::ifstream is(filename, ::std::ios_base::in|::std::ios_base::binary);
+        if( !is.is_open() )
+        {
+            throw ::std::runtime_error("Unable to open file '" + filename + "'");
+        }
+        auto buf = ::std::make_shared< ::std::vector<char> >( ::std::istreambuf_iterator<char>(is), ::std::istreambuf_iterator<char>() );
+        m_data = buf->data();
+        m_data_len = buf->size();
+        m_data_owner = mv$(buf);
+    }
+
     // Consume the BOM
-    if( this->getc_byte() == '\xef' )
+    if( m_data_len > 0 && m_data[0] == '\xef' )
     {
+        this->getc_byte();
         if( this->getc_byte() != '\xbb' ) {
             throw ::std::runtime_error("Incomplete BOM - missing \\xBB in second position");
         }
@@ -41,10 +116,6 @@ Lexer::Lexer(const ::std::string& filename):
         }
         m_line_ofs = 0;
     }
-    else
-    {
-        m_istream.unget();
-    }
 }
 
 
@@ -313,8 +384,9 @@ Token Lexer::getTokenInt()
             return Token(TOK_NEWLINE);
         if( ch.isspace() )
         {
-            while( (ch = this->getc()).isspace() && ch != '\n' )
-                ;
+            do {
+                this->take_ascii_run(s_char_classes.space);
+            } while( (ch = this->getc()).isspace() && ch != '\n' );
             this->ungetc();
             return Token(TOK_WHITESPACE);
         }
@@ -382,6 +454,13 @@ Token Lexer::getTokenInt()
                         while( ch.isdigit() ) {
                             val *= 10;
                             val += ch.v - '0';
+                            auto run = this->take_ascii_run(s_char_classes.digit);
+                            for(size_t i = 0; i < run.second; i ++) {
+                                if( run.first[i] != '_' ) {
+                                    val *= 10;
+                                    val += run.first[i] - '0';
+                                }
+                            }
                             ch = this->getc_num();
                         }
                     }
@@ -390,6 +469,13 @@ Token Lexer::getTokenInt()
                     while( ch.isdigit() ) {
                         val *= 10;
                         val += ch.v - '0';
+                        auto run = this->take_ascii_run(s_char_classes.digit);
+                        for(size_t i = 0; i < run.second; i ++) {
+                            if( run.first[i] != '_' ) {
+                                val *= 10;
+                                val += run.first[i] - '0';
+                            }
+                        }
                         ch = this->getc_num();
                     }
                 }
@@ -592,6 +678,8 @@ Token Lexer::getTokenInt()
                 while(ch != '\n' && ch != '\r')
                 {
                     str += ch;
+                    auto run = this->take_ascii_text('\n', '\r');
+                    str.append(run.first, run.second);
                     ch = this->getc();
                 }
                 this->ungetc();
@@ -654,6 +742,8 @@ Token Lexer::getTokenInt()
                         }
                         else {
                             str += ch;
+                            auto run = this->take_ascii_text('/', '*');
+                            str.append(run.first, run.second);
                         }
                     }
                     ch = this->getc();
@@ -810,6 +900,8 @@ Token Lexer::getTokenInt_Identifier(Codepoint leader, Codepoint leader2)
     while( issym(ch) )
     {
         str += ch;
+        auto run = this->take_ascii_run(s_char_classes.ident);
+        str.append(run.first, run.second);
         ch = this->getc();
     }
 
@@ -935,9 +1027,9 @@ uint32_t Lexer::parseEscape(char enclosing)
 
 char Lexer::getc_byte()
 {
-    int rv = m_istream.get();
-    if( rv == EOF || m_istream.eof() )
+    if( m_data_pos == m_data_len )
         throw Lexer::EndOfFile();
+    char rv = m_data[m_data_pos++];
 
     if( rv == '\n' )
     {
@@ -1032,6 +1124,54 @@ Codepoint Lexer::getc_cp()
     }
 }
 
+/// Consume a run of ASCII characters in the given class directly from the buffer (none if a character is pushed back)
+::std::pair<const char*,size_t> Lexer::take_ascii_run(const bool (&class_tbl)[128])
+{
+    const char* start = m_data + m_data_pos;
+    if( m_last_char_valid )
+        return ::std::make_pair(start, 0);
+    size_t  len = 0;
+    while( m_data_pos + len < m_data_len )
+    {
+        uint8_t c = static_cast<uint8_t>(start[len]);
+        if( c >= 128 || !class_tbl[c] )
+            break;
+        len ++;
+    }
+    // NOTE: None of the classes include newlines
+    m_data_pos += len;
+    m_line_ofs += len;
+    return ::std::make_pair(start, len);
+}
+/// Consume a run of ASCII text (stopping at either of the stop characters, or at a newline), a word at a time
+::std::pair<const char*,size_t> Lexer::take_ascii_text(char stop1, char stop2)
+{
+    const char* start = m_data + m_data_pos;
+    if( m_last_char_valid )
+        return ::std::make_pair(start, 0);
+    size_t  len = 0;
+    size_t  avail = m_data_len - m_data_pos;
+    while( len + 8 <= avail )
+    {
+        uint64_t    w;
+        memcpy(&w, start + len, 8);
+        if( (w & WORD_HIGHS) != 0 || word_has_byte(w, '\n') || word_has_byte(w, '\r') || word_has_byte(w, stop1) || word_has_byte(w, stop2) )
+            break;
+        len += 8;
+    }
+    // Finish off byte-by-byte (including the word that contained a stop character)
+    while( len < avail )
+    {
+        char c = start[len];
+        if( (c & 0x80) != 0 || c == '\n' || c == '\r' || c == stop1 || c == stop2 )
+            break;
+        len ++;
+    }
+    m_data_pos += len;
+    m_line_ofs += len;
+    return ::std::make_pair(start, len);
+}
+
 void Lexer::ungetc()
 {
 #ifdef TRACE_CHARS
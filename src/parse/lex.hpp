@@ -9,7 +9,7 @@
 #define LEX_HPP_INCLUDED
 
 #include <string>
-#include <fstream>
+#include <memory>
 #include "tokenstream.hpp"
 
 struct Codepoint {
@@ -39,7 +39,12 @@ class Lexer:
     unsigned int m_line;
     unsigned int m_line_ofs;
 
-    ::std::ifstream m_istream;
+    // Entire source file (mapped, or read into memory if that isn't possible)
+    ::std::shared_ptr<const void>   m_data_owner;
+    const char* m_data;
+    size_t  m_data_len;
+    size_t  m_data_pos;
+
     bool    m_last_char_valid;
     Codepoint   m_last_char;
     ::std::vector<Token>    m_next_tokens;
@@ -69,6 +74,8 @@ private:
     }
 
     void ungetc();
+    ::std::pair<const char*,size_t> take_ascii_run(const bool (&class_tbl)[128]);
+    ::std::pair<const char*,size_t> take_ascii_text(char stop1, char stop2);
     Codepoint getc_num();
     Codepoint getc();
     Codepoint getc_cp();
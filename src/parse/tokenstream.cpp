@@ -109,6 +109,14 @@ eTokenType TokenStream::lookahead(unsigned int i)
     return m_lookahead[i].first.type();
 }
 
+bool TokenStream::take_tt(TokenTree& out)
+{
+    // Only valid if the last token handed out was the last one read from the underlying stream
+    if( m_cache_valid || m_lookahead.size() > 0 )
+        return false;
+    return this->realTakeTT(out);
+}
+
 Ident::Hygiene TokenStream::getHygiene() const
 {
     return m_hygiene;
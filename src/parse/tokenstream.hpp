@@ -59,6 +59,9 @@ public:
     Token   getToken();
     void    putback(Token tok);
     eTokenType  lookahead(unsigned int count);
+    // If the last token returned opened a bracketed tree that the stream holds whole (e.g. a substituted `tt`
+    // capture), consumes the rest of that tree and returns it in `out` (sharing it where possible).
+    bool    take_tt(TokenTree& out);
 
     Ident::Hygiene getHygiene() const;
     virtual void push_hygine() {}
@@ -77,6 +80,7 @@ protected:
     virtual ::std::shared_ptr<Span> outerSpan() const { return ::std::shared_ptr<Span>(0); }
     virtual Token   realGetToken() = 0;
     virtual Ident::Hygiene realGetHygiene() const = 0;
+    virtual bool realTakeTT(TokenTree& out) { return false; }
 private:
     Token innerGetToken();
 };
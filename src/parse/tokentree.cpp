@@ -8,8 +8,22 @@
 #include "tokentree.hpp"
 #include <common.hpp>
 
+TokenTree TokenTree::make_shared(TokenTree tt)
+{
+    if( tt.m_shared )
+        return tt;
+    TokenTree   rv;
+    rv.m_shared = ::std::make_shared<const TokenTree>( mv$(tt) );
+    return rv;
+}
+
 TokenTree TokenTree::clone() const
 {
+    if( m_shared ) {
+        TokenTree   rv;
+        rv.m_shared = m_shared;
+        return rv;
+    }
     if( m_subtrees.size() == 0 ) {
         return TokenTree(m_hygiene, m_tok.clone());
     }
@@ -24,6 +38,8 @@ TokenTree TokenTree::clone() const
 
 ::std::ostream& operator<<(::std::ostream& os, const TokenTree& tt)
 {
+    if( tt.m_shared )
+        return os << *tt.m_shared;
     if( tt.m_subtrees.size() == 0 )
     {
         switch(tt.m_tok.type())
@@ -11,12 +11,15 @@
 #include "token.hpp"
 #include <ident.hpp>
 #include <vector>
+#include <memory>
 
 class TokenTree
 {
     Ident::Hygiene m_hygiene;
     Token   m_tok;
     ::std::vector<TokenTree>    m_subtrees;
+    // If set, this node refers to an immutable tree shared with other nodes (and the above fields are unused)
+    ::std::shared_ptr<const TokenTree>  m_shared;
 public:
     virtual ~TokenTree() {}
     TokenTree() {}
@@ -41,19 +44,30 @@ public:
     {
     }
 
+    /// Move a tree into shared storage, so cloning the returned node only copies a reference
+    static TokenTree make_shared(TokenTree tt);
+
+    /// Deep copy, except for shared nodes (which are copied by reference)
     TokenTree clone() const;
 
+    bool is_shared() const {
+        return static_cast<bool>(m_shared);
+    }
     bool is_token() const {
-        return m_tok.type() != TOK_NULL;
+        return m_shared ? m_shared->is_token() : m_tok.type() != TOK_NULL;
     }
     unsigned int size() const {
-        return m_subtrees.size();
+        return m_shared ? m_shared->size() : m_subtrees.size();
+    }
+    const TokenTree& operator[](unsigned int idx) const {
+        if( m_shared )  return (*m_shared)[idx];
+        assert(idx < m_subtrees.size()); return m_subtrees[idx];
     }
-    const TokenTree& operator[](unsigned int idx) const { assert(idx < m_subtrees.size()); return m_subtrees[idx]; }
-          TokenTree& operator[](unsigned int idx)       { assert(idx < m_subtrees.size()); return m_subtrees[idx]; }
-    const Token& tok() const { return m_tok; }
-          Token& tok()       { return m_tok; }
-    const Ident::Hygiene& hygiene() const { return m_hygiene; }
+    // NOTE: Mutable access is only valid on unshared nodes
+          TokenTree& operator[](unsigned int idx)       { assert(!m_shared); assert(idx < m_subtrees.size()); return m_subtrees[idx]; }
+    const Token& tok() const { return m_shared ? m_shared->tok() : m_tok; }
+          Token& tok()       { assert(!m_shared); return m_tok; }
+    const Ident::Hygiene& hygiene() const { return m_shared ? m_shared->hygiene() : m_hygiene; }
 
     friend ::std::ostream& operator<<(::std::ostream& os, const TokenTree& tt);
 };
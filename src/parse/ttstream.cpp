@@ -8,6 +8,13 @@
 #include "ttstream.hpp"
 #include <common.hpp>
 
+namespace {
+    bool is_group_open(eTokenType ty)
+    {
+        return ty == TOK_PAREN_OPEN || ty == TOK_SQUARE_OPEN || ty == TOK_BRACE_OPEN;
+    }
+}
+
 TTStream::TTStream(Span parent, const TokenTree& input_tt):
     m_parent_span( new Span(mv$(parent)) )
 {
@@ -19,6 +26,7 @@ TTStream::~TTStream()
 }
 Token TTStream::realGetToken()
 {
+    m_last_was_group_open = false;
     while(m_stack.size() > 0)
     {
         // If current index is above TT size, go up
@@ -28,8 +36,9 @@ Token TTStream::realGetToken()
 
         if(idx == 0 && tree.is_token()) {
             idx ++;
+            m_last_pos = tree.tok().get_pos();
             m_hygiene_ptr = &tree.hygiene();
-            return tree.tok();
+            return tree.tok().clone();
         }
 
         if(idx < tree.size())
@@ -37,6 +46,8 @@ Token TTStream::realGetToken()
             const TokenTree&    subtree = tree[idx];
             idx ++;
             if( subtree.size() == 0 ) {
+                m_last_was_group_open = (idx == 1 && is_group_open(subtree.tok().type()));
+                m_last_pos = subtree.tok().get_pos();
                 m_hygiene_ptr = &subtree.hygiene();
                 return subtree.tok().clone();
             }
@@ -51,10 +62,19 @@ Token TTStream::realGetToken()
     //m_hygiene = nullptr;
     return Token(TOK_EOF);
 }
+bool TTStream::realTakeTT(TokenTree& out)
+{
+    if( !m_last_was_group_open )
+        return false;
+    m_last_was_group_open = false;
+    // Shared groups (e.g. nested captures) are copied by reference
+    out = m_stack.back().second->clone();
+    m_stack.pop_back();
+    return true;
+}
 Position TTStream::getPosition() const
 {
-    // TODO: Position associated with the previous/next token?
-    return Position("TTStream", 0,0);
+    return m_last_pos;
 }
 Ident::Hygiene TTStream::realGetHygiene() const
 {
@@ -69,37 +89,49 @@ TTStreamO::TTStreamO(Span parent, TokenTree input_tt):
     m_input_tt( mv$(input_tt) ),
     m_parent_span( new Span(mv$(parent)) )
 {
-    m_stack.push_back( ::std::make_pair(0, nullptr) );
+    m_stack.push_back( StackEnt { 0, nullptr, true } );
 }
 TTStreamO::~TTStreamO()
 {
 }
 Token TTStreamO::realGetToken()
 {
+    m_last_was_group_open = false;
     while(m_stack.size() > 0)
     {
         // If current index is above TT size, go up
-        unsigned int& idx = m_stack.back().first;
-        TokenTree& tree = (m_stack.back().second ? *m_stack.back().second : m_input_tt);
+        auto& ent = m_stack.back();
+        const TokenTree& tree = (ent.tree ? *ent.tree : m_input_tt);
+        // Tokens are moved out of owned nodes, and cloned from shared ones
+        bool inner_owned = ent.owned && !tree.is_shared();
+        auto take_tok = [&](const TokenTree& node)->Token {
+            m_last_pos = node.tok().get_pos();
+            m_hygiene_ptr = &node.hygiene();
+            // NOTE: `const_cast` is valid, the node is owned by this stream
+            return inner_owned ? mv$(const_cast<TokenTree&>(node).tok()) : node.tok().clone();
+            };
 
-        if(idx == 0 && tree.is_token()) {
-            idx ++;
-            m_last_pos = tree.tok().get_pos();
-            m_hygiene_ptr = &tree.hygiene();
-            return mv$(tree.tok());
+        if(ent.idx == 0 && tree.is_token()) {
+            ent.idx ++;
+            return take_tok(tree);
         }
 
-        if(idx < tree.size())
+        if(ent.idx < tree.size())
         {
-            TokenTree& subtree = tree[idx];
-            idx ++;
+            const TokenTree& subtree = tree[ent.idx];
+            ent.idx ++;
             if( subtree.size() == 0 ) {
-                m_last_pos = subtree.tok().get_pos();
-                m_hygiene_ptr = &subtree.hygiene();
-                return mv$( subtree.tok() );
+                if( ent.idx == 1 && is_group_open(subtree.tok().type()) ) {
+                    // Left in place (brackets have no data to move), so `realTakeTT` can move the group out whole
+                    m_last_was_group_open = true;
+                    m_last_pos = subtree.tok().get_pos();
+                    m_hygiene_ptr = &subtree.hygiene();
+                    return subtree.tok().clone();
+                }
+                return take_tok(subtree);
             }
             else {
-                m_stack.push_back( ::std::make_pair(0, &subtree) );
+                m_stack.push_back( StackEnt { 0, &subtree, inner_owned } );
             }
         }
         else {
@@ -108,6 +140,20 @@ Token TTStreamO::realGetToken()
     }
     return Token(TOK_EOF);
 }
+bool TTStreamO::realTakeTT(TokenTree& out)
+{
+    if( !m_last_was_group_open )
+        return false;
+    m_last_was_group_open = false;
+    const auto& ent = m_stack.back();
+    const TokenTree& tree = (ent.tree ? *ent.tree : m_input_tt);
+    if( ent.owned )
+        out = mv$( const_cast<TokenTree&>(tree) );
+    else
+        out = tree.clone();
+    m_stack.pop_back();
+    return true;
+}
 Position TTStreamO::getPosition() const
 {
     return m_last_pos;
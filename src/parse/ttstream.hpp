@@ -14,9 +14,12 @@
 class TTStream:
     public TokenStream
 {
+    Position    m_last_pos;
     ::std::vector< ::std::pair<unsigned int, const TokenTree*> > m_stack;
     ::std::shared_ptr<Span> m_parent_span;
     const Ident::Hygiene*   m_hygiene_ptr = nullptr;
+    // Set if the last token returned was the opening bracket of the group at the top of the stack
+    bool    m_last_was_group_open = false;
 public:
     TTStream(Span parent, const TokenTree& input_tt);
     ~TTStream();
@@ -29,16 +32,26 @@ public:
 protected:
     Ident::Hygiene realGetHygiene() const override;
     Token realGetToken() override;
+    bool realTakeTT(TokenTree& out) override;
 };
 
 /// Owned TTStream
 class TTStreamO:
     public TokenStream
 {
+    struct StackEnt {
+        unsigned int    idx;
+        // `nullptr` for `m_input_tt`
+        const TokenTree*    tree;
+        // Set if this node is in owned storage (and can be moved from), clear within shared trees
+        bool    owned;
+    };
     Position    m_last_pos;
     TokenTree   m_input_tt;
-    ::std::vector< ::std::pair<unsigned int, TokenTree*> > m_stack;
+    ::std::vector<StackEnt> m_stack;
     const Ident::Hygiene*   m_hygiene_ptr = nullptr;
+    // Set if the last token returned was the opening bracket of the group at the top of the stack
+    bool    m_last_was_group_open = false;
 public:
     ::std::shared_ptr<Span> m_parent_span;
     TTStreamO(Span parent, TokenTree input_tt);
@@ -54,4 +67,5 @@ public:
 protected:
     Ident::Hygiene realGetHygiene() const override;
     Token realGetToken() override;
+    bool realTakeTT(TokenTree& out) override;
 };
@@ -1,44 +1,97 @@
 /*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * rc_string.cpp
+ * - Interned string pool
  */
 #include <rc_string.hpp>
 #include <cstring>
-#include <iostream>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <mutex>
 
-RcString::RcString(const char* s, unsigned int len):
-    m_ptr(nullptr),
-    m_len(len)
+class RcStringPool
 {
-    if( len > 0 )
+    typedef RcString::Inner Inner;
+
+    // Split into shards (selected by hash) so worker threads rarely contend on the same lock
+    static const size_t NUM_SHARDS = 16;
+    struct Shard
     {
-        m_ptr = new unsigned int[1 + (len+1 + sizeof(unsigned int)-1) / sizeof(unsigned int)];
-        *m_ptr = 1;
-        char* data_mut = reinterpret_cast<char*>(m_ptr + 1);
-        for(unsigned int j = 0; j < len; j ++ )
-            data_mut[j] = s[j];
-        data_mut[len] = '\0';
+        ::std::mutex    lock;
+        // Storage for the strings, `deque` doesn't move existing entries when it grows
+        ::std::deque<Inner> arena;
+        // Open-addressed hash table (linear probing) of pointers into `arena`, size is a power of two
+        ::std::vector<const Inner*> table;
+
+        void rehash()
+        {
+            ::std::vector<const Inner*> new_table( table.empty() ? 256 : table.size() * 2 );
+            size_t  mask = new_table.size() - 1;
+            for(const auto* e : table)
+            {
+                if( !e )
+                    continue ;
+                size_t i = e->hash & mask;
+                while( new_table[i] )
+                    i = (i + 1) & mask;
+                new_table[i] = e;
+            }
+            table = ::std::move(new_table);
+        }
+    };
+    Shard   m_shards[NUM_SHARDS];
+
+public:
+    static RcStringPool& get() {
+        // Never freed, interned strings live until exit
+        static RcStringPool* s_pool = new RcStringPool();
+        return *s_pool;
     }
-}
-RcString::~RcString()
-{
-    if(m_ptr)
+
+    const Inner* intern(const char* s, size_t len)
     {
-        *m_ptr -= 1;
-        //::std::cout << "RcString(\"" << *this << "\") - " << *m_ptr << " refs left" << ::std::endl;
-        if( *m_ptr == 0 )
+        size_t  hash = RcString::hash_bytes(s, len);
+        auto& shard = m_shards[ (hash >> 24) % NUM_SHARDS ];
+        ::std::lock_guard<::std::mutex> lh { shard.lock };
+
+        // Keep the load factor below 1/2
+        if( shard.arena.size() * 2 >= shard.table.size() )
+            shard.rehash();
+
+        size_t  mask = shard.table.size() - 1;
+        size_t  i = hash & mask;
+        while( const auto* e = shard.table[i] )
         {
-            delete[] m_ptr;
-            m_ptr = nullptr;
+            if( e->hash == hash && e->str.size() == len && ::std::memcmp(e->str.data(), s, len) == 0 )
+                return e;
+            i = (i + 1) & mask;
         }
+        shard.arena.push_back(Inner { hash, ::std::string(s, len) });
+        shard.table[i] = &shard.arena.back();
+        return shard.table[i];
+    }
+};
+
+RcString::RcString(const char* s, size_t len):
+    m_ptr(nullptr)
+{
+    if( len > 0 )
+    {
+        m_ptr = RcStringPool::get().intern(s, len);
     }
 }
-bool RcString::operator==(const char* s) const
+
+size_t RcString::hash_bytes(const char* s, size_t len)
 {
-    if( m_len == 0 )
-        return *s == '\0';
-    auto m = this->c_str();
-    do {
-        if( *m != *s )
-            return false;
-    } while( *m++ != '\0' && *s++ != '\0' );
-    return true;
+    // FNV-1a
+    uint64_t    h = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < len; i ++)
+    {
+        h ^= static_cast<uint8_t>(s[i]);
+        h *= 0x100000001b3ull;
+    }
+    return static_cast<size_t>(h);
 }
@@ -0,0 +1,134 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * stats.cpp
+ * - Hot-path counters and sampled timers (reported by `--stats`)
+ */
+#include <stats.hpp>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iomanip>
+
+namespace Stats {
+
+bool g_enabled = false;
+thread_local unsigned t_sample_tick = 0;
+
+namespace {
+    // Intrusive list of all counters (counters are function-local statics, so can be constructed on any thread)
+    ::std::atomic<Counter*> g_counters { nullptr };
+
+    struct Values
+    {
+        uint64_t    count = 0;
+        uint64_t    samples = 0;
+        uint64_t    sampled_ns = 0;
+
+        /// Estimated total time (nanoseconds), extrapolated from the sampled calls
+        double est_ns() const {
+            return samples > 0 ? static_cast<double>(sampled_ns) / samples * count : 0.0;
+        }
+    };
+    struct PhaseStats
+    {
+        ::std::string   name;
+        ::std::vector< ::std::pair<const char*, Values> >   counters;
+    };
+    // Values at the end of the last phase
+    ::std::map<const Counter*, Values>  g_last_values;
+    ::std::vector<PhaseStats>   g_phases;
+
+    void print_table(::std::ostream& os, const ::std::vector< ::std::pair<const char*, Values> >& counters)
+    {
+        auto list = counters;
+        // Timed counters first (by estimated time), then the rest by count
+        ::std::sort(list.begin(), list.end(), [](const auto& a, const auto& b) {
+            if( a.second.est_ns() != b.second.est_ns() )
+                return a.second.est_ns() > b.second.est_ns();
+            return a.second.count > b.second.count;
+            });
+        for(const auto& e : list)
+        {
+            os << "  " << ::std::left << ::std::setw(48) << e.first << ::std::right << ::std::setw(14) << e.second.count;
+            if( e.second.samples > 0 ) {
+                os << ::std::setw(12) << ::std::fixed << ::std::setprecision(3) << e.second.est_ns() / 1e6 << "ms";
+                os << ::std::setw(10) << ::std::setprecision(0) << static_cast<double>(e.second.sampled_ns) / e.second.samples << "ns/call";
+            }
+            os << "\n";
+        }
+    }
+}
+
+Counter::Counter(const char* name):
+    name(name),
+    count(0),
+    samples(0),
+    sampled_ns(0),
+    next(g_counters.load())
+{
+    while( !g_counters.compare_exchange_weak(this->next, this) )
+        ;
+}
+
+void begin()
+{
+    g_phases.clear();
+    end_phase("");
+    g_phases.clear();
+}
+
+void end_phase(const char* phase_name)
+{
+    PhaseStats  ps;
+    ps.name = phase_name;
+    for(const Counter* c = g_counters.load(); c; c = c->next)
+    {
+        Values  cur;
+        cur.count = c->count.load(::std::memory_order_relaxed);
+        cur.samples = c->samples.load(::std::memory_order_relaxed);
+        cur.sampled_ns = c->sampled_ns.load(::std::memory_order_relaxed);
+
+        auto& last = g_last_values[c];
+        Values  delta;
+        delta.count = cur.count - last.count;
+        delta.samples = cur.samples - last.samples;
+        delta.sampled_ns = cur.sampled_ns - last.sampled_ns;
+        last = cur;
+
+        if( delta.count > 0 )
+            ps.counters.push_back( ::std::make_pair(c->name, delta) );
+    }
+    if( !ps.counters.empty() )
+        g_phases.push_back( ::std::move(ps) );
+}
+
+void print_report(::std::ostream& os)
+{
+    os << "--- Statistics (calls, estimated inclusive time from 1/" << SAMPLE_PERIOD << " sampled calls) ---\n";
+    for(const auto& ps : g_phases)
+    {
+        os << ps.name << ":\n";
+        print_table(os, ps.counters);
+    }
+
+    ::std::map<const char*, Values> totals_map;
+    for(const auto& ps : g_phases)
+    {
+        for(const auto& e : ps.counters)
+        {
+            auto& t = totals_map[e.first];
+            t.count += e.second.count;
+            t.samples += e.second.samples;
+            t.sampled_ns += e.second.sampled_ns;
+        }
+    }
+    ::std::vector< ::std::pair<const char*, Values> >   totals(totals_map.begin(), totals_map.end());
+    os << "Total:\n";
+    print_table(os, totals);
+    os << ::std::flush;
+}
+
+}   // namespace Stats
@@ -11,6 +11,7 @@
 #include <mir/mir.hpp>
 #include <mir/operations.hpp>
 #include <algorithm>
+#include <parallel.hpp>
 
 #include "codegen.hpp"
 #include "monomorphise.hpp"
@@ -26,9 +27,13 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
     }
     else
     {
-        codegen = Trans_Codegen_GetGeneratorC(crate, outfile);
+        codegen = Trans_Codegen_GetGeneratorC(crate, outfile, opt.codegen_units);
     }
 
+    // NOTE: The TransList containers are hashed, so sort them to keep the output deterministic
+    auto functions = sorted_entries(list.m_functions);
+    auto statics = sorted_entries(list.m_statics);
+
     // 1. Emit structure/type definitions.
     // - Emit in the order they're needed.
     for(const auto& ty : list.m_types)
@@ -57,13 +62,14 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
             codegen->emit_type(ty.first);
         }
     }
-    for(const auto& ty : list.m_typeids)
+    for(const auto* ty : sorted_entries(list.m_typeids))
     {
-        codegen->emit_type_id(ty);
+        codegen->emit_type_id(*ty);
     }
     // Emit required constructor methods (and other wrappers)
-    for(const auto& path : list.m_constructors)
+    for(const auto* path_ptr : sorted_entries(list.m_constructors))
     {
+        const auto& path = *path_ptr;
         // Get the item type
         // - Function (must be an intrinsic)
         // - Struct (must be a tuple struct)
@@ -91,8 +97,9 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
     }
 
     // 2. Emit function prototypes
-    for(const auto& ent : list.m_functions)
+    for(const auto* ent_ptr : functions)
     {
+        const auto& ent = *ent_ptr;
         DEBUG("FUNCTION " << ent.first);
         assert( ent.second->ptr );
         const auto& fcn = *ent.second->ptr;
@@ -103,8 +110,9 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
         }
     }
     // - External functions
-    for(const auto& ent : list.m_functions)
+    for(const auto* ent_ptr : functions)
     {
+        const auto& ent = *ent_ptr;
         //DEBUG("FUNCTION " << ent.first);
         assert( ent.second->ptr );
         const auto& fcn = *ent.second->ptr;
@@ -121,8 +129,9 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
         }
     }
     // VTables (may be needed by statics)
-    for(const auto& ent : list.m_vtables)
+    for(const auto* ent_ptr : sorted_entries(list.m_vtables))
     {
+        const auto& ent = *ent_ptr;
         const auto& trait = ent.first.m_data.as_UfcsKnown().trait;
         const auto& type = *ent.first.m_data.as_UfcsKnown().type;
         DEBUG("VTABLE " << trait << " for " << type);
@@ -130,8 +139,9 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
         codegen->emit_vtable(ent.first, crate.get_trait_by_path(Span(), trait.m_path));
     }
     // 3. Emit statics
-    for(const auto& ent : list.m_statics)
+    for(const auto* ent_ptr : statics)
     {
+        const auto& ent = *ent_ptr;
         DEBUG("STATIC proto " << ent.first);
         assert(ent.second->ptr);
         const auto& stat = *ent.second->ptr;
@@ -145,45 +155,94 @@ void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const
             codegen->emit_static_ext(ent.first, stat, ent.second->pp);
         }
     }
-    for(const auto& ent : list.m_statics)
-    {
-        DEBUG("STATIC " << ent.first);
-        assert(ent.second->ptr);
-        const auto& stat = *ent.second->ptr;
+    auto emit_static_values = [&](CodeGenerator& cg) {
+        for(const auto* ent_ptr : statics)
+        {
+            const auto& ent = *ent_ptr;
+            DEBUG("STATIC " << ent.first);
+            assert(ent.second->ptr);
+            const auto& stat = *ent.second->ptr;
 
-        if( ! stat.m_value_res.is_Invalid() )
+            if( ! stat.m_value_res.is_Invalid() )
+            {
+                cg.emit_static_local(ent.first, stat, ent.second->pp);
+            }
+        }
+        };
+    auto emit_function_code = [&](CodeGenerator& cg, const ::HIR::Path& path, const TransList_Function& ent) {
+        const auto& fcn = *ent.ptr;
+        const auto& pp = ent.pp;
+        TRACE_FUNCTION_F(path);
+        DEBUG("FUNCTION CODE " << path);
+        // `is_extern` is set if there's no HIR (i.e. this function is from an external crate)
+        bool is_extern = ! static_cast<bool>(fcn.m_code);
+        // If this is a provided trait method, it needs to be monomorphised too.
+        bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef("Self",0xFFFF);}) );
+        if( pp.has_types() || is_method )
         {
-            codegen->emit_static_local(ent.first, stat, ent.second->pp);
+            ASSERT_BUG(sp, ent.monomorphised.code, "Function that required monomorphisation wasn't monomorphised");
+
+            // TODO: Flag that this should be a weak (or weak-er) symbol?
+            // - If it's from an external crate, it should be weak, but what about local ones?
+            cg.emit_function_code(path, fcn, ent.pp, is_extern,  ent.monomorphised.code);
         }
-    }
+        else {
+            cg.emit_function_code(path, fcn, pp, is_extern,  fcn.m_code.m_mir);
+        }
+        };
 
+    auto units = codegen->split_units();
+    if( units.empty() )
+    {
+        emit_static_values(*codegen);
 
-    // 4. Emit function code
-    for(const auto& ent : list.m_functions)
+        // 4. Emit function code
+        for(const auto* ent_ptr : functions)
+        {
+            const auto& ent = *ent_ptr;
+            if( ent.second->ptr && ent.second->ptr->m_code.m_mir )
+            {
+                emit_function_code(*codegen, ent.first, *ent.second);
+            }
+        }
+    }
+    else
     {
-        if( ent.second->ptr && ent.second->ptr->m_code.m_mir )
+        // 4. Distribute function code between the units
+        // - Greedy assignment to the (first) least loaded unit, weighted by MIR size. Deterministic, so the output
+        //   doesn't change between runs.
+        ::std::vector< ::std::vector<const decltype(list.m_functions)::value_type*> >  unit_functions( units.size() );
+        ::std::vector<size_t>   unit_weights( units.size() );
+        for(const auto* ent_ptr : functions)
         {
-            const auto& path = ent.first;
-            const auto& fcn = *ent.second->ptr;
-            const auto& pp = ent.second->pp;
-            TRACE_FUNCTION_F(path);
-            DEBUG("FUNCTION CODE " << path);
-            // `is_extern` is set if there's no HIR (i.e. this function is from an external crate)
-            bool is_extern = ! static_cast<bool>(fcn.m_code);
-            // If this is a provided trait method, it needs to be monomorphised too.
-            bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef("Self",0xFFFF);}) );
-            if( pp.has_types() || is_method )
+            const auto& ent = *ent_ptr;
+            if( ent.second->ptr && ent.second->ptr->m_code.m_mir )
             {
-                ASSERT_BUG(sp, ent.second->monomorphised.code, "Function that required monomorphisation wasn't monomorphised");
+                const auto& code = ent.second->monomorphised.code ? ent.second->monomorphised.code : ent.second->ptr->m_code.m_mir;
+                size_t weight = 1;
+                for(const auto& blk : code->blocks)
+                    weight += 1 + blk.statements.size();
 
-                // TODO: Flag that this should be a weak (or weak-er) symbol?
-                // - If it's from an external crate, it should be weak, but what about local ones?
-                codegen->emit_function_code(path, fcn, ent.second->pp, is_extern,  ent.second->monomorphised.code);
-            }
-            else {
-                codegen->emit_function_code(path, fcn, pp, is_extern,  fcn.m_code.m_mir);
+                auto idx = ::std::min_element(unit_weights.begin(), unit_weights.end()) - unit_weights.begin();
+                unit_functions[idx].push_back(&ent);
+                unit_weights[idx] += weight;
             }
         }
+
+        parallel_for(units.size(), [&](unsigned int /*worker_idx*/, size_t unit_idx) {
+            auto& cg = *units[unit_idx];
+            // Static values go in the first unit
+            if( unit_idx == 0 )
+            {
+                emit_static_values(cg);
+            }
+            for(const auto* ent : unit_functions[unit_idx])
+            {
+                emit_function_code(cg, ent->first, *ent->second);
+            }
+            // Close the unit's output
+            units[unit_idx].reset();
+            });
     }
 
     codegen->finalise(is_executable, opt);
@@ -29,6 +29,12 @@ public:
     virtual ~CodeGenerator() {}
     virtual void finalise(bool is_executable, const TransOptions& opt) {}
 
+    /// Split the remaining output (static values and function code) into separately-compiled units
+    /// - Called once all shared items (types, prototypes, vtables) have been emitted
+    /// - The returned generators may be used concurrently, and must be destroyed before `finalise` is called
+    /// - An empty list means that the backend doesn't support splitting (or only one unit was requested)
+    virtual ::std::vector< ::std::unique_ptr<CodeGenerator> > split_units() { return {}; }
+
     // Called on all types directly mentioned (e.g. variables, arguments, and fields)
     // - Inner-most types are visited first.
     virtual void emit_type_proto(const ::HIR::TypeRef& ) {}
@@ -55,6 +61,6 @@ public:
 };
 
 
-extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile);
+extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, unsigned int codegen_units);
 extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile);
 
@@ -10,6 +10,8 @@
 #include <fstream>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <parallel.hpp>
 #include <hir/hir.hpp>
 #include <mir/mir.hpp>
 #include <hir_typeck/static.hpp>
@@ -196,13 +198,20 @@ namespace {
         } m_options;
 
         ::std::vector< ::std::pair< ::HIR::GenericPath, const ::HIR::Struct*> >   m_box_glue_todo;
+
+        // Number of units that function code is split into (if above 1, `m_of` is the shared header until `split_units`)
+        unsigned int    m_unit_count = 1;
+        ::std::string   m_outfile_path_h;
+        // Source files created by `split_units`
+        ::std::vector< ::std::string>   m_unit_files;
     public:
-        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile):
+        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile, unsigned int codegen_units):
             m_crate(crate),
             m_resolve(crate),
             m_outfile_path(outfile),
             m_outfile_path_c(outfile + ".c"),
-            m_of(m_outfile_path_c)
+            m_unit_count(codegen_units),
+            m_outfile_path_h(outfile + ".h")
         {
             switch(Target_GetCurSpec().m_codegen_mode)
             {
@@ -219,8 +228,11 @@ namespace {
                 m_compiler = Compiler::Msvc;
                 m_options.emulated_i128 = true;
                 m_options.disallow_empty_structs = true;
+                // Combining the unit objects would need `lib.exe`, which isn't supported (rejected by the command-line parser)
+                ASSERT_BUG(Span(), m_unit_count <= 1, "--codegen-units=" << m_unit_count << " passed to the MSVC backend");
                 break;
             }
+            m_of.open(m_unit_count > 1 ? m_outfile_path_h : m_outfile_path_c);
 
             m_of
                 << "/*\n"
@@ -500,14 +512,52 @@ namespace {
                 ;
         }
 
+        // Create a generator for one of the units of a split output (see `split_units`)
+        CodeGenerator_C(const CodeGenerator_C& parent, size_t unit_idx):
+            m_crate(parent.m_crate),
+            m_resolve(parent.m_crate),
+            m_outfile_path(parent.m_outfile_path),
+            m_outfile_path_c(parent.m_unit_files.at(unit_idx)),
+            m_of(m_outfile_path_c),
+            m_compiler(parent.m_compiler),
+            m_options(parent.m_options),
+            m_unit_count(parent.m_unit_count),
+            m_outfile_path_h(parent.m_outfile_path_h)
+        {
+            emit_header_include();
+        }
+
         ~CodeGenerator_C() {}
 
+        ::std::vector< ::std::unique_ptr<CodeGenerator> > split_units() override
+        {
+            ::std::vector< ::std::unique_ptr<CodeGenerator> >   rv;
+            if( m_unit_count <= 1 )
+                return rv;
+
+            // Box drop glue can't wait until `finalise`, as the header is used by every unit
+            emit_box_drop_glue_todo();
+            m_of.flush();
+            m_of.close();
+
+            for(unsigned int i = 0; i < m_unit_count; i ++)
+            {
+                m_unit_files.push_back( FMT(m_outfile_path << ".u" << i << ".c") );
+                rv.push_back( ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(*this, i)) );
+            }
+            return rv;
+        }
+
         void finalise(bool is_executable, const TransOptions& opt) override
         {
-            // Emit box drop glue after everything else to avoid definition ordering issues
-            for(auto& e : m_box_glue_todo)
+            emit_box_drop_glue_todo();
+
+            if( !m_unit_files.empty() && is_executable )
             {
-                emit_box_drop_glue( mv$(e.first), *e.second );
+                // The header has already been closed, `main` goes in its own file
+                m_of.open(m_outfile_path_c);
+                emit_header_include();
+                m_unit_files.push_back(m_outfile_path_c);
             }
 
             if( is_executable )
@@ -556,35 +606,78 @@ namespace {
 #else
             bool is_windows = false;
 #endif
+            // Compilation of split units, run concurrently before `args`
+            ::std::vector<StringList>   unit_args;
             switch( m_compiler )
             {
-            case Compiler::Gcc:
-                if( getenv("CC") ) {
-                    args.push_back( getenv("CC") );
-                }
-                else {
-                    //args.push_back( Target_GetCurSpec().m_c_compiler + "-gcc" );
-                    args.push_back( "gcc" );
-                }
-                args.push_back("-ffunction-sections");
-                args.push_back("-pthread");
-                switch(opt.opt_level)
+            case Compiler::Gcc: {
+                auto push_cc_args = [&](StringList& args) {
+                    if( getenv("CC") ) {
+                        args.push_back( getenv("CC") );
+                    }
+                    else {
+                        //args.push_back( Target_GetCurSpec().m_c_compiler + "-gcc" );
+                        args.push_back( "gcc" );
+                    }
+                    args.push_back("-ffunction-sections");
+                    args.push_back("-pthread");
+                    switch(opt.opt_level)
+                    {
+                    case 0: break;
+                    case 1:
+                        args.push_back("-O1");
+                        break;
+                    case 2:
+                        args.push_back("-O2");
+                        break;
+                    }
+                    if( opt.emit_debug_info )
+                    {
+                        args.push_back("-g");
+                    }
+                    if( opt.lto )
+                    {
+                        args.push_back("-flto");
+                        // Libraries keep machine code too, so they can still be used by a non-LTO link
+                        if( !is_executable )
+                            args.push_back("-ffat-lto-objects");
+                    }
+                    // NOTE: Profiles are matched to object files by path, so the use build needs the same output paths
+                    if( opt.profile_generate )
+                    {
+                        args.push_back(opt.profile_generate_dir == "" ? ::std::string("-fprofile-generate") : "-fprofile-generate=" + opt.profile_generate_dir);
+                    }
+                    if( opt.profile_use_dir != "" )
+                    {
+                        args.push_back("-fprofile-use=" + opt.profile_use_dir);
+                        // Counters from multi-threaded programs aren't updated atomically, so can be slightly inconsistent
+                        args.push_back("-fprofile-correction");
+                        // Crates that weren't used by the training run don't have a profile
+                        args.push_back("-Wno-missing-profile");
+                    }
+                    };
+                push_cc_args(args);
+                args.push_back("-o");
+                args.push_back(m_outfile_path.c_str());
+                if( m_unit_files.empty() )
                 {
-                case 0: break;
-                case 1:
-                    args.push_back("-O1");
-                    break;
-                case 2:
-                    args.push_back("-O2");
-                    break;
+                    args.push_back(m_outfile_path_c.c_str());
                 }
-                if( opt.emit_debug_info )
+                else
                 {
-                    args.push_back("-g");
+                    for(const auto& unit_file : m_unit_files)
+                    {
+                        auto unit_obj = unit_file.substr(0, unit_file.size() - 2) + ".o";
+                        StringList  cargs;
+                        push_cc_args(cargs);
+                        cargs.push_back("-c");
+                        cargs.push_back("-o");
+                        cargs.push_back(unit_obj);
+                        cargs.push_back(unit_file);
+                        unit_args.push_back(mv$(cargs));
+                        args.push_back(unit_obj);
+                    }
                 }
-                args.push_back("-o");
-                args.push_back(m_outfile_path.c_str());
-                args.push_back(m_outfile_path_c.c_str());
                 if( is_executable )
                 {
                     for( const auto& crate : m_crate.m_ext_crates )
@@ -612,11 +705,17 @@ namespace {
                     }
                     args.push_back("-Wl,--gc-sections");
                 }
+                else if( !m_unit_files.empty() )
+                {
+                    // Combine the unit objects into a single relocatable object
+                    args.push_back("-r");
+                    args.push_back("-nostdlib");
+                }
                 else
                 {
                     args.push_back("-c");
                 }
-                break;
+                } break;
             case Compiler::Msvc:
                 // TODO: Look up these paths in the registry and use CreateProcess instead of system
                 args.push_back(detect_msvc().path_vcvarsall);
@@ -640,6 +739,14 @@ namespace {
                     args.push_back("/DEBUG");
                     args.push_back("/Zi");
                 }
+                if( opt.lto )
+                {
+                    args.push_back("/GL");
+                }
+                if( opt.profile_generate || opt.profile_use_dir != "" )
+                {
+                    ::std::cerr << "warning: Profile-guided optimisation isn't supported with MSVC, ignored" << ::std::endl;
+                }
                 if(is_executable)
                 {
                     args.push_back(FMT("/Fe" << m_outfile_path));
@@ -669,6 +776,10 @@ namespace {
                     // Command-line specified linker search directories
                     args.push_back("/link");
                     //args.push_back("/verbose");
+                    if( opt.lto )
+                    {
+                        args.push_back("/LTCG");
+                    }
                     for(const auto& path : link_dirs )
                     {
                         args.push_back(FMT("/LIBPATH:" << path));
@@ -682,34 +793,28 @@ namespace {
                 break;
             }
 
-            ::std::stringstream cmd_ss;
-            if (is_windows)
-            {
-                cmd_ss << "echo \"\" & ";
-            }
-            for(const auto& arg : args.get_vec())
-            {
-                if(strcmp(arg, "&") == 0 && is_windows) {
-                    cmd_ss << "&";
+            auto format_command = [&](const StringList& args) {
+                ::std::stringstream cmd_ss;
+                if (is_windows)
+                {
+                    cmd_ss << "echo \"\" & ";
                 }
-                else {
-                    if( is_windows && strchr(arg, ' ') == nullptr ) {
-                        cmd_ss << arg << " ";
-                        continue ;
+                for(const auto& arg : args.get_vec())
+                {
+                    if(strcmp(arg, "&") == 0 && is_windows) {
+                        cmd_ss << "&";
+                    }
+                    else {
+                        if( is_windows && strchr(arg, ' ') == nullptr ) {
+                            cmd_ss << arg << " ";
+                            continue ;
+                        }
+                        cmd_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
                     }
-                    cmd_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
                 }
-            }
-            //DEBUG("- " << cmd_ss.str());
-            ::std::cout << "Running comamnd - " << cmd_ss.str() << ::std::endl;
-            if( opt.build_command_file != "" )
-            {
-                ::std::cerr << "INVOKE CC: " << cmd_ss.str() << ::std::endl;
-                ::std::ofstream(opt.build_command_file) << cmd_ss.str() << ::std::endl;
-            }
-            else
-            {
-                int ec = system(cmd_ss.str().c_str());
+                return cmd_ss.str();
+                };
+            auto check_exit_code = [](int ec) {
                 if( ec == -1 )
                 {
                     ::std::cerr << "C Compiler failed to execute (system returned -1)" << ::std::endl;
@@ -721,9 +826,71 @@ namespace {
                     ::std::cerr << "C Compiler failed to execute - error code " << ec << ::std::endl;
                     exit(1);
                 }
+                };
+
+            ::std::vector< ::std::string>   unit_cmds;
+            for(const auto& a : unit_args)
+            {
+                unit_cmds.push_back( format_command(a) );
+                ::std::cout << "Running comamnd - " << unit_cmds.back() << ::std::endl;
+            }
+            auto cmd = format_command(args);
+            //DEBUG("- " << cmd);
+            ::std::cout << "Running comamnd - " << cmd << ::std::endl;
+            if( opt.build_command_file != "" )
+            {
+                ::std::ofstream os(opt.build_command_file);
+                for(const auto& unit_cmd : unit_cmds)
+                {
+                    ::std::cerr << "INVOKE CC: " << unit_cmd << ::std::endl;
+                    os << unit_cmd << ::std::endl;
+                }
+                ::std::cerr << "INVOKE CC: " << cmd << ::std::endl;
+                os << cmd << ::std::endl;
             }
+            else
+            {
+                // Compile the units on the worker threads (so at most `-j` compiler processes run at once), then link/combine them
+                ::std::vector<int>  unit_ecs( unit_cmds.size() );
+                parallel_for(unit_cmds.size(), [&](unsigned int , size_t i) {
+                    unit_ecs[i] = system(unit_cmds[i].c_str());
+                    });
+                for(int ec : unit_ecs)
+                    check_exit_code(ec);
+
+                check_exit_code( system(cmd.c_str()) );
+            }
+        }
+
+        void emit_header_include()
+        {
+            // Units are written next to the header, so only the file name is needed
+            auto slash_pos = m_outfile_path_h.find_last_of("/\\");
+            m_of
+                << "/*\n"
+                << " * AUTOGENERATED by mrustc\n"
+                << " */\n"
+                << "#include \"" << (slash_pos == ::std::string::npos ? m_outfile_path_h : m_outfile_path_h.substr(slash_pos+1)) << "\"\n"
+                ;
+        }
+        // Linkage for functions that are private to this output (e.g. monomorphised functions from other crates)
+        // - When split into multiple units, these need to be visible to the other units.
+        const char* local_fcn_linkage() const
+        {
+            if( m_unit_count > 1 )
+                return "__attribute__((weak,visibility(\"hidden\"))) ";
+            return "static ";
         }
 
+        void emit_box_drop_glue_todo()
+        {
+            // Emit box drop glue after everything else to avoid definition ordering issues
+            for(auto& e : m_box_glue_todo)
+            {
+                emit_box_drop_glue( mv$(e.first), *e.second );
+            }
+            m_box_glue_todo.clear();
+        }
         void emit_box_drop_glue(::HIR::GenericPath p, const ::HIR::Struct& item)
         {
             auto struct_ty = ::HIR::TypeRef( p.clone(), &item );
@@ -1007,7 +1174,7 @@ namespace {
                 if( p.m_path.m_crate_name != m_crate.m_crate_name )
                 {
                     if( item.m_params.m_types.size() > 0 ) {
-                        m_of << "static ";
+                        m_of << local_fcn_linkage();
                     }
                     else {
                         m_of << "extern ";
@@ -1442,6 +1609,11 @@ namespace {
 
             TRACE_FUNCTION_F(p);
             auto type = params.monomorph(m_resolve, item.m_type);
+            // With multiple units, the definition is only in one of them
+            if( m_unit_count > 1 )
+            {
+                m_of << "extern ";
+            }
             emit_ctype( type, FMT_CB(ss, ss << Trans_Mangle(p);) );
             m_of << ";";
             m_of << "\t// static " << p << " : " << type;
@@ -1827,7 +1999,7 @@ namespace {
 
             {
                 auto vtable_sp = trait_path.m_path;
-                vtable_sp.m_components.back() += "#vtable";
+                vtable_sp.m_components.back() = vtable_sp.m_components.back() + "#vtable";
                 auto vtable_params = trait_path.m_params.clone();
                 for(const auto& ty : trait.m_type_indexes) {
                     auto aty = ::HIR::TypeRef( ::HIR::Path( type.clone(), trait_path.clone(), ty.first ) );
@@ -1976,7 +2148,7 @@ namespace {
             }
             if( is_extern_def )
             {
-                m_of << "static ";
+                m_of << local_fcn_linkage();
             }
             emit_function_header(p, item, params);
             m_of << ";\n";
@@ -1999,7 +2171,7 @@ namespace {
 
             m_of << "// " << p << "\n";
             if( is_extern_def ) {
-                m_of << "static ";
+                m_of << local_fcn_linkage();
             }
             emit_function_header(p, item, params);
             m_of << "\n";
@@ -5448,7 +5620,7 @@ namespace {
     Span CodeGenerator_C::sp;
 }
 
-::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile)
+::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, unsigned int codegen_units)
 {
-    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile));
+    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile, codegen_units));
 }
@@ -322,7 +322,7 @@ namespace
                         //auto vtp = t.m_data.as_TraitObject().m_trait.m_path;
 
                         auto vtable_gp = te.m_trait.m_path.clone();
-                        vtable_gp.m_path.m_components.back() += "#vtable";
+                        vtable_gp.m_path.m_components.back() = vtable_gp.m_path.m_components.back() + "#vtable";
                         const auto& trait = resolve.m_crate.get_trait_by_path(sp, te.m_trait.m_path.m_path);
                         vtable_gp.m_params.m_types.resize( vtable_gp.m_params.m_types.size() + trait.m_type_indexes.size() );
                         for(const auto& ty : trait.m_type_indexes) {
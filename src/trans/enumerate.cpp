@@ -14,8 +14,11 @@
 #include <hir_typeck/common.hpp>    // monomorph
 #include <hir_typeck/static.hpp>    // StaticTraitResolve
 #include <hir/item_path.hpp>
+#include <hir/type_intern.hpp>
 #include <deque>
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace {
     struct EnumState
@@ -23,12 +26,16 @@ namespace {
         const ::HIR::Crate& crate;
         TransList   rv;
 
+        // Shared by all lookups (so its `find_impl` cache is re-used)
+        StaticTraitResolve  resolve;
+
         // Queue of items to enumerate
         ::std::deque<TransList_Function*>  fcn_queue;
         ::std::vector<TransList_Function*> fcns_to_type_visit;
 
         EnumState(const ::HIR::Crate& crate):
-            crate(crate)
+            crate(crate),
+            resolve(crate)
         {}
 
         void enum_fcn(::HIR::Path p, const ::HIR::Function& fcn, Trans_Params pp)
@@ -339,8 +346,10 @@ void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list)
     // TODO: Get a list of "root" functions (e.g. main, public functions, things used by public generics) and re-enumerate based on that.
 
     // Visit every function used
-    for(const auto& ent : list.m_functions)
+    // - Sorted, as this determines the order that types are enumerated (and thus emitted)
+    for(const auto* ent_ptr : sorted_entries(list.m_functions))
     {
+        const auto& ent = *ent_ptr;
         if( ent.second->monomorphised.code )
         {
             Trans_Enumerate_FillFrom_MIR(state, *ent.second->monomorphised.code, {});
@@ -413,7 +422,8 @@ namespace {
         ::StaticTraitResolve    m_resolve;
         ::std::vector< ::std::pair< ::HIR::TypeRef, bool> >& out_list;
 
-        ::std::map< ::HIR::TypeRef, bool > visited;
+        // NOTE: Not interned, the visitor is short-lived and this avoids the pool's lock (and never-freed storage)
+        ::std::unordered_map< ::HIR::TypeRef, bool > visited;
         ::std::set< const ::HIR::TypeRef*, PtrComp> active_set;
 
         TypeVisitor(const ::HIR::Crate& crate, ::std::vector< ::std::pair< ::HIR::TypeRef, bool > >& out_list):
@@ -579,7 +589,7 @@ namespace {
 
                     ASSERT_BUG(Span(), ! te.m_trait.m_path.m_path.m_components.empty(), "TODO: Data trait is empty, what can be done?");
                     auto vtable_ty_spath = te.m_trait.m_path.m_path;
-                    vtable_ty_spath.m_components.back() += "#vtable";
+                    vtable_ty_spath.m_components.back() = vtable_ty_spath.m_components.back() + "#vtable";
                     const auto& vtable_ref = m_crate.get_struct_by_path(sp, vtable_ty_spath);
                     // Copy the param set from the trait in the trait object
                     ::HIR::PathParams   vtable_params = te.m_trait.m_path.m_params.clone();
@@ -1004,8 +1014,9 @@ void Trans_Enumerate_Types(EnumState& state)
         }
         state.fcns_to_type_visit.clear();
         // TODO: Similarly restrict revisiting of statics.
-        for(const auto& ent : state.rv.m_statics)
+        for(const auto* ent_ptr : sorted_entries(state.rv.m_statics))
         {
+            const auto& ent = *ent_ptr;
             TRACE_FUNCTION_F("Enumerate static " << ent.first);
             assert(ent.second->ptr);
             const auto& stat = *ent.second->ptr;
@@ -1013,14 +1024,15 @@ void Trans_Enumerate_Types(EnumState& state)
 
             tv.visit_type( pp.monomorph(tv.m_resolve, stat.m_type) );
         }
-        for(const auto& ent : state.rv.m_vtables)
+        for(const auto* ent_ptr : sorted_entries(state.rv.m_vtables))
         {
+            const auto& ent = *ent_ptr;
             TRACE_FUNCTION_F("vtable " << ent.first);
             const auto& gpath = ent.first.m_data.as_UfcsKnown().trait;
             const auto& trait = state.crate.get_trait_by_path(sp, gpath.m_path);
 
             auto vtable_ty_spath = gpath.m_path;
-            vtable_ty_spath.m_components.back() += "#vtable";
+            vtable_ty_spath.m_components.back() = vtable_ty_spath.m_components.back() + "#vtable";
             const auto& vtable_ref = state.crate.get_struct_by_path(sp, vtable_ty_spath);
             // Copy the param set from the trait in the trait object
             ::HIR::PathParams   vtable_params = gpath.m_params.clone();
@@ -1151,10 +1163,10 @@ namespace {
         )
         BUG(sp, "Path " << path << " pointed to a invalid item - " << vip->tag_str());
     }
-    EntPtr get_ent_fullpath(const Span& sp, const ::HIR::Crate& crate, const ::HIR::Path& path, ::HIR::PathParams& impl_pp)
+    EntPtr get_ent_fullpath(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::Path& path, ::HIR::PathParams& impl_pp)
     {
         TRACE_FUNCTION_F(path);
-        StaticTraitResolve  resolve { crate };
+        const auto& crate = resolve.m_crate;
 
         if( const auto* pe = path.m_data.opt_Generic() )
         {
@@ -1331,12 +1343,12 @@ void Trans_Enumerate_FillFrom_Path(EnumState& state, const ::HIR::Path& path, co
         ),
     (UfcsKnown,
         sub_pp.pp_method = pe.params.clone();
-        sub_pp.self_type = pe.type->clone();
+        sub_pp.self_type = ::HIR::InternedType::intern(*pe.type);
         ),
     (UfcsInherent,
         sub_pp.pp_method = pe.params.clone();
         sub_pp.pp_impl = pe.impl_params.clone();
-        sub_pp.self_type = pe.type->clone();
+        sub_pp.self_type = ::HIR::InternedType::intern(*pe.type);
         ),
     (UfcsUnknown,
         BUG(sp, "UfcsUnknown - " << path);
@@ -1344,7 +1356,7 @@ void Trans_Enumerate_FillFrom_Path(EnumState& state, const ::HIR::Path& path, co
     )
     // Get the item type
     // - Valid types are Function and Static
-    auto item_ref = get_ent_fullpath(sp, state.crate, path_mono, sub_pp.pp_impl);
+    auto item_ref = get_ent_fullpath(sp, state.resolve, path_mono, sub_pp.pp_impl);
     TU_MATCHA( (item_ref), (e),
     (NotFound,
         BUG(sp, "Item not found for " << path_mono);
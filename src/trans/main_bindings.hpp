@@ -18,7 +18,18 @@ struct TransOptions
     ::std::string   mode = "c";
     unsigned int opt_level = 0;
     bool emit_debug_info = false;
+    /// Link-time optimisation (objects carry compiler IR, so code from other crates can be inlined in the final link)
+    bool lto = false;
+    /// Profile-guided optimisation: emit instrumented code (profiles are written to `profile_generate_dir` if set)
+    bool profile_generate = false;
+    ::std::string   profile_generate_dir;
+    /// Profile-guided optimisation: optimise using the profiles in this directory (from a `profile_generate` build)
+    ::std::string   profile_use_dir;
+    /// Number of C files (and compiler invocations) that function code is split between
+    unsigned int codegen_units = 1;
     ::std::string   build_command_file;
+    /// Directory of cached monomorphised MIR (see trans/mono_cache.hpp), empty to disable
+    ::std::string   mono_cache_dir;
 
     ::std::vector< ::std::string>   library_search_dirs;
     ::std::vector< ::std::string>   libraries;
@@ -31,6 +42,6 @@ extern TransList Trans_Enumerate_Public(::HIR::Crate& crate);
 /// Re-run enumeration on monomorphised functions, removing now-unused items
 extern void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list);
 
-extern void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list);
+extern void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list, const TransOptions& opt);
 
 extern void Trans_Codegen(const ::std::string& outfile, const TransOptions& opt, const ::HIR::Crate& crate, const TransList& list, bool is_executable);
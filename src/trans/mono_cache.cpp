@@ -0,0 +1,329 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * trans/mono_cache.cpp
+ * - On-disk cache of monomorphised MIR, shared between compiler invocations
+ */
+#include "mono_cache.hpp"
+#include "target.hpp"
+#include <hir/hir.hpp>
+#include <hir/main_bindings.hpp>
+#include <hir_typeck/common.hpp>    // visit_ty_with
+#include <mir/mir.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+# include <Windows.h>
+# include <direct.h>    // _mkdir
+# include <process.h>   // _getpid
+# define getpid _getpid
+#else
+# include <unistd.h>    // getpid
+#endif
+
+namespace {
+    /// Bumped if the layout of cache entries changes
+    const unsigned int MONO_CACHE_VERSION = 1;
+
+    /// FNV-1a hash (64-bit), `h` is the hash of any preceding data
+    uint64_t hash_bytes(uint64_t h, const void* data, size_t len)
+    {
+        const auto* p = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < len; i ++)
+        {
+            h ^= p[i];
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+    const uint64_t HASH_INIT = 0xcbf29ce484222325ull;
+
+    /// Hash the contents of a file (returns zero if it can't be read)
+    uint64_t hash_file(const ::std::string& path)
+    {
+        ::std::ifstream is(path, ::std::ios_base::in|::std::ios_base::binary);
+        if( !is.is_open() )
+            return 0;
+        uint64_t    h = HASH_INIT;
+        char    buf[64*1024];
+        while( is.read(buf, sizeof(buf)) || is.gcount() > 0 )
+        {
+            h = hash_bytes(h, buf, static_cast<size_t>(is.gcount()));
+        }
+        return h;
+    }
+
+    /// Identify the running compiler build (size and modification time of the executable), empty if unknown
+    ::std::string get_compiler_stamp()
+    {
+#ifdef _WIN32
+        char    path[MAX_PATH];
+        DWORD len = GetModuleFileNameA(NULL, path, sizeof(path));
+        if( len == 0 || len == sizeof(path) )
+            return "";
+        struct _stat64 s;
+        if( _stat64(path, &s) != 0 )
+            return "";
+#else
+        struct stat s;
+        if( stat("/proc/self/exe", &s) != 0 )
+            return "";
+#endif
+        ::std::stringstream ss;
+        ss << s.st_size << "-" << s.st_mtime;
+        return ss.str();
+    }
+
+    /// Collect the crates named by a path (returns false if it refers to something that can't be cached)
+    bool get_path_crates(const ::HIR::Path& path, ::std::set< ::std::string>& out);
+    bool get_params_crates(const ::HIR::PathParams& pp, ::std::set< ::std::string>& out)
+    {
+        for(const auto& ty : pp.m_types)
+        {
+            bool ok = true;
+            visit_ty_with(ty, [&](const ::HIR::TypeRef& t) {
+                TU_MATCH_DEF(::HIR::TypeRef::Data, (t.m_data), (e),
+                (
+                    ),
+                (Infer,      ok = false; ),
+                (Generic,    ok = false; ),
+                (ErasedType, ok = false; ),
+                (Closure,    ok = false; ),
+                (Path,
+                    TU_MATCH_DEF(::HIR::Path::Data, (e.path.m_data), (pe),
+                    (
+                        ),
+                    (Generic,
+                        out.insert( pe.m_path.m_crate_name.c_str() );
+                        ),
+                    (UfcsKnown,
+                        out.insert( pe.trait.m_path.m_crate_name.c_str() );
+                        )
+                    )
+                    ),
+                (TraitObject,
+                    out.insert( e.m_trait.m_path.m_path.m_crate_name.c_str() );
+                    for(const auto& m : e.m_markers)
+                        out.insert( m.m_path.m_crate_name.c_str() );
+                    )
+                )
+                return !ok;
+                });
+            if( !ok )
+                return false;
+        }
+        return true;
+    }
+    bool get_path_crates(const ::HIR::Path& path, ::std::set< ::std::string>& out)
+    {
+        TU_MATCH(::HIR::Path::Data, (path.m_data), (pe),
+        (Generic,
+            out.insert( pe.m_path.m_crate_name.c_str() );
+            return get_params_crates(pe.m_params, out);
+            ),
+        (UfcsInherent,
+            ::HIR::PathParams   tmp;
+            tmp.m_types.push_back( pe.type->clone() );
+            return get_params_crates(tmp, out) && get_params_crates(pe.params, out) && get_params_crates(pe.impl_params, out);
+            ),
+        (UfcsKnown,
+            out.insert( pe.trait.m_path.m_crate_name.c_str() );
+            ::HIR::PathParams   tmp;
+            tmp.m_types.push_back( pe.type->clone() );
+            return get_params_crates(tmp, out) && get_params_crates(pe.trait.m_params, out) && get_params_crates(pe.params, out);
+            ),
+        (UfcsUnknown,
+            return false;
+            )
+        )
+        throw "";
+    }
+
+    /// Record the defining crate of every function in a module (and its submodules and traits)
+    void add_module_functions(const ::HIR::Module& mod, const ::std::string& crate_name, ::std::unordered_map<const ::HIR::Function*, ::std::string>& out)
+    {
+        for(const auto& vi : mod.m_value_items)
+        {
+            if( const auto* e = vi.second->ent.opt_Function() )
+                out.insert(::std::make_pair(e, crate_name));
+        }
+        for(const auto& ti : mod.m_mod_items)
+        {
+            TU_MATCH_DEF(::HIR::TypeItem, (ti.second->ent), (e),
+            (
+                ),
+            (Module,
+                add_module_functions(e, crate_name, out);
+                ),
+            (Trait,
+                for(const auto& v : e.m_values)
+                {
+                    if( const auto* f = v.second.opt_Function() )
+                        out.insert(::std::make_pair(f, crate_name));
+                }
+                )
+            )
+        }
+    }
+    void add_crate_functions(const ::HIR::Crate& crate, const ::std::string& crate_name, ::std::unordered_map<const ::HIR::Function*, ::std::string>& out)
+    {
+        add_module_functions(crate.m_root_module, crate_name, out);
+        for(const auto& impl : crate.m_type_impls)
+        {
+            for(const auto& m : impl.m_methods)
+                out.insert(::std::make_pair(&m.second.data, crate_name));
+        }
+        for(const auto& impl : crate.m_trait_impls)
+        {
+            for(const auto& m : impl.second.m_methods)
+                out.insert(::std::make_pair(&m.second.data, crate_name));
+        }
+    }
+}
+
+MonoCache::MonoCache(const ::HIR::Crate& crate, const ::std::string& dir):
+    m_dir(dir),
+    m_local_crate(crate.m_crate_name)
+{
+    auto stamp = get_compiler_stamp();
+    if( stamp == "" )
+    {
+        // Entries from a different compiler build could be silently wrong, so don't use the cache at all
+        ::std::cerr << "warning: Can't identify the compiler executable, monomorphisation cache disabled" << ::std::endl;
+        return ;
+    }
+#ifdef _WIN32
+    _mkdir(m_dir.c_str());
+#else
+    mkdir(m_dir.c_str(), 0755);
+#endif
+
+    // Hash each crate's metadata, then fold in the (already computed) hashes of its dependencies
+    ::std::unordered_map< ::std::string, uint64_t>  file_hashes;
+    for(const auto& ec : crate.m_ext_crates)
+    {
+        file_hashes[ec.first] = hash_file(ec.second.m_path);
+    }
+    ::std::function<uint64_t(const ::std::string&)> get_hash = [&](const ::std::string& name)->uint64_t {
+        auto it = m_crate_hashes.find(name);
+        if( it != m_crate_hashes.end() )
+            return it->second;
+        auto fh_it = file_hashes.find(name);
+        if( fh_it == file_hashes.end() || fh_it->second == 0 )
+            return m_crate_hashes[name] = 0;
+        uint64_t h = fh_it->second;
+        // NOTE: Sorted, so the hash doesn't depend on hash map order
+        ::std::vector< ::std::string>   deps;
+        for(const auto& dep : crate.m_ext_crates.at(name).m_data->m_ext_crates)
+            deps.push_back(dep.first);
+        ::std::sort(deps.begin(), deps.end());
+        for(const auto& dep : deps)
+        {
+            uint64_t dh = get_hash(dep);
+            if( dh == 0 )
+                return m_crate_hashes[name] = 0;
+            h = hash_bytes(h, &dh, sizeof(dh));
+        }
+        return m_crate_hashes[name] = h;
+        };
+    for(const auto& ec : crate.m_ext_crates)
+        get_hash(ec.first);
+
+    add_crate_functions(crate, m_local_crate, m_function_crates);
+    for(const auto& ec : crate.m_ext_crates)
+        add_crate_functions(*ec.second.m_data, ec.first, m_function_crates);
+
+    const auto& target = Target_GetCurSpec();
+    ::std::stringstream ss;
+    ss << "v" << MONO_CACHE_VERSION << " " << stamp << " " << target.m_arch.m_name << "-" << target.m_os_name << "-" << target.m_env_name;
+    m_key_prefix = ss.str();
+}
+
+::std::string MonoCache::get_key(const ::HIR::Path& path, const ::HIR::Function& fcn) const
+{
+    if( !is_enabled() )
+        return "";
+    // The defining crate is needed even if the path doesn't name it (e.g. inherent methods on primitives)
+    auto fc_it = m_function_crates.find(&fcn);
+    if( fc_it == m_function_crates.end() )
+        return "";
+    ::std::set< ::std::string>  crates;
+    crates.insert(fc_it->second);
+    if( !get_path_crates(path, crates) )
+        return "";
+
+    ::std::stringstream ss;
+    ss << m_key_prefix;
+    for(const auto& c : crates)
+    {
+        if( c == m_local_crate || c == "" )
+            return "";
+        auto it = m_crate_hashes.find(c);
+        if( it == m_crate_hashes.end() || it->second == 0 )
+            return "";
+        ss << " " << c << "=" << ::std::hex << ::std::setw(16) << ::std::setfill('0') << it->second << ::std::dec;
+    }
+    ss << "\n" << path;
+    return ss.str();
+}
+
+::std::string MonoCache::get_filename(const ::std::string& key) const
+{
+    uint64_t h = hash_bytes(HASH_INIT, key.data(), key.size());
+    ::std::stringstream ss;
+    ss << m_dir << "/" << ::std::hex << ::std::setw(16) << ::std::setfill('0') << h << ".mir";
+    return ss.str();
+}
+
+::MIR::FunctionPointer MonoCache::load(const ::std::string& key) const
+{
+    auto filename = get_filename(key);
+    struct stat s;
+    if( stat(filename.c_str(), &s) != 0 )
+        return ::MIR::FunctionPointer();
+    try
+    {
+        ::HIR::serialise::Reader    in { filename };
+        // The full key is stored, in case of a filename hash collision
+        if( in.read_string() != key )
+            return ::MIR::FunctionPointer();
+        return HIR_DeserialiseMir(in);
+    }
+    catch(const ::std::runtime_error& e)
+    {
+        DEBUG("Failed to read " << filename << ": " << e.what());
+        return ::MIR::FunctionPointer();
+    }
+}
+
+void MonoCache::store(const ::std::string& key, const ::MIR::Function& fcn) const
+{
+    static ::std::atomic<unsigned>  s_tmp_index;
+    auto filename = get_filename(key);
+    // Written to a temporary and renamed, so concurrent compiles never see a partial entry
+    auto tmp_filename = FMT(filename << "." << getpid() << "-" << s_tmp_index++ << ".tmp");
+    try
+    {
+        ::HIR::serialise::Writer    out { tmp_filename, ::HIR::serialise::Compression::None };
+        out.write_string(key);
+        HIR_SerialiseMir(out, fcn);
+    }
+    catch(const ::std::runtime_error& e)
+    {
+        DEBUG("Failed to write " << tmp_filename << ": " << e.what());
+        ::std::remove(tmp_filename.c_str());
+        return ;
+    }
+    if( ::std::rename(tmp_filename.c_str(), filename.c_str()) != 0 )
+    {
+        ::std::remove(tmp_filename.c_str());
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * trans/mono_cache.hpp
+ * - On-disk cache of monomorphised MIR, shared between compiler invocations
+ */
+#pragma once
+
+#include <mir/mir_ptr.hpp>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+namespace HIR {
+class Crate;
+class Path;
+class Function;
+}
+
+/// Cache of monomorphised (and optimised) function bodies, enabled with `-C mono-cache=<dir>`
+///
+/// An entry is keyed on the instance path and the metadata of every crate that could affect its body (the crate
+/// defining the function, the crates named in the path, and all of their dependencies), so it can be reused by any
+/// crate that instantiates the same function. Instances involving the crate being compiled are never cached.
+///
+/// Entries are never evicted: ones for old compiler builds or old versions of a crate are just no longer looked up,
+/// so the directory grows until it's cleared (which is always safe).
+class MonoCache
+{
+    ::std::string   m_dir;
+    ::std::string   m_local_crate;
+    /// Prefix of all keys (cache format, compiler build, and target)
+    ::std::string   m_key_prefix;
+    /// Hash of each extern crate's metadata file, combined with the hashes of its dependencies
+    ::std::unordered_map< ::std::string, uint64_t>  m_crate_hashes;
+    /// Crate that defines each function (functions not listed here are never cached)
+    ::std::unordered_map<const ::HIR::Function*, ::std::string> m_function_crates;
+
+public:
+    MonoCache(const ::HIR::Crate& crate, const ::std::string& dir);
+
+    bool is_enabled() const { return !m_key_prefix.empty(); }
+
+    /// Get the cache key for an instance of `fcn` (empty if it can't be cached)
+    ::std::string get_key(const ::HIR::Path& path, const ::HIR::Function& fcn) const;
+
+    /// Load a cached body (returns a null pointer if there isn't one)
+    ::MIR::FunctionPointer load(const ::std::string& key) const;
+    void store(const ::std::string& key, const ::MIR::Function& fcn) const;
+
+private:
+    ::std::string get_filename(const ::std::string& key) const;
+};
@@ -6,10 +6,14 @@
  * - MIR monomorphisation
  */
 #include "monomorphise.hpp"
+#include "main_bindings.hpp"
+#include "mono_cache.hpp"
 #include "hir_typeck/static.hpp"
 #include <mir/mir.hpp>
 #include <hir/hir.hpp>
 #include <mir/operations.hpp>   // Needed for post-monomorph checks and optimisations
+#include <stats.hpp>
+#include <parallel.hpp>
 
 namespace {
     ::MIR::LValue monomorph_LValue(const ::StaticTraitResolve& resolve, const Trans_Params& params, const ::MIR::LValue& tpl)
@@ -337,9 +341,14 @@ namespace {
 }
 
 /// Monomorphise all functions in a TransList
-void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
+void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list, const TransOptions& opt)
 {
-    ::StaticTraitResolve    resolve { crate };
+    ::std::unique_ptr<MonoCache>    cache;
+    if( opt.mono_cache_dir != "" )
+        cache.reset(new MonoCache(crate, opt.mono_cache_dir));
+
+    // Collect the functions that need monomorphising (each job only writes to its own entry)
+    ::std::vector<::std::pair<const ::HIR::Path*, TransList_Function*>>    jobs;
     for(auto& fcn_ent : list.m_functions)
     {
         const auto& fcn = *fcn_ent.second->ptr;
@@ -347,18 +356,44 @@ void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
         bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef("Self",0xFFFF);}) );
         if(fcn_ent.second->pp.has_types() || is_method)
         {
-            const auto& path = fcn_ent.first;
-            const auto& pp = fcn_ent.second->pp;
-            TRACE_FUNCTION_FR(path, path);
+            jobs.push_back(::std::make_pair( &fcn_ent.first, &*fcn_ent.second ));
+        }
+    }
 
-            auto mir = Trans_Monomorphise(resolve, fcn_ent.second->pp, fcn.m_code.m_mir);
+    // Each worker needs its own resolver (it holds a cache)
+    unsigned int n_workers = parallel_worker_count(jobs.size());
+    ::std::vector<::std::unique_ptr<StaticTraitResolve>>    resolvers;
+    for(unsigned int i = 0; i < n_workers; i ++)
+        resolvers.push_back( ::std::unique_ptr<StaticTraitResolve>(new StaticTraitResolve(crate)) );
 
-            // TODO: Should these be moved to their own pass? Potentially not, the extra pass should just be an inlining optimise pass
-            auto ret_type = pp.monomorph(resolve, fcn.m_return);
-            ::HIR::Function::args_t args;
-            for(const auto& a : fcn.m_args)
-                args.push_back(::std::make_pair( ::HIR::Pattern{}, pp.monomorph(resolve, a.second) ));
+    parallel_for(jobs.size(), [&](unsigned int worker_idx, size_t job_idx) {
+        const auto& path = *jobs[job_idx].first;
+        auto& ent = *jobs[job_idx].second;
+        const auto& resolve = *resolvers[worker_idx];
+        const auto& fcn = *ent.ptr;
+        const auto& pp = ent.pp;
+        TRACE_FUNCTION_FR(path, path);
+
+        auto ret_type = pp.monomorph(resolve, fcn.m_return);
+        ::HIR::Function::args_t args;
+        for(const auto& a : fcn.m_args)
+            args.push_back(::std::make_pair( ::HIR::Pattern{}, pp.monomorph(resolve, a.second) ));
+
+        ::std::string   cache_key;
+        ::MIR::FunctionPointer  mir;
+        if( cache )
+        {
+            cache_key = cache->get_key(path, fcn);
+            if( cache_key != "" )
+                mir = cache->load(cache_key);
+            if( mir )
+                STATS_COUNT("MonoCache hit");
+        }
+        if( !mir )
+        {
+            mir = Trans_Monomorphise(resolve, pp, fcn.m_code.m_mir);
 
+            // TODO: Should these be moved to their own pass? Potentially not, the extra pass should just be an inlining optimise pass
             ::std::string s = FMT(path);
             ::HIR::ItemPath ip(s);
             MIR_Validate(resolve, ip, *mir, args, ret_type);
@@ -366,10 +401,16 @@ void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
             MIR_Optimise(resolve, ip, *mir, args, ret_type);
             MIR_Validate(resolve, ip, *mir, args, ret_type);
 
-            fcn_ent.second->monomorphised.ret_ty = ::std::move(ret_type);
-            fcn_ent.second->monomorphised.arg_tys = ::std::move(args);
-            fcn_ent.second->monomorphised.code = ::std::move(mir);
+            if( cache_key != "" )
+            {
+                STATS_COUNT("MonoCache miss");
+                cache->store(cache_key, *mir);
+            }
         }
-    }
+
+        ent.monomorphised.ret_ty = ::std::move(ret_type);
+        ent.monomorphised.arg_tys = ::std::move(args);
+        ent.monomorphised.code = ::std::move(mir);
+        });
 }
 
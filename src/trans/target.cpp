@@ -10,8 +10,12 @@
 #include "../expand/cfg.hpp"
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <hir/hir.hpp>
 #include <hir_typeck/helpers.hpp>
+#include <hir/type_intern.hpp>
+#include <unordered_map>
+#include <stats.hpp>
 
 TargetArch ARCH_X86_64 = {
     "x86_64",
@@ -135,6 +139,10 @@ const TargetSpec& Target_GetCurSpec()
 {
     return g_target;
 }
+CodegenMode Target_GetCodegenMode(const ::std::string& target_name)
+{
+    return init_from_spec_name(target_name).m_codegen_mode;
+}
 void Target_SetCfg(const ::std::string& target_name)
 {
     g_target = init_from_spec_name(target_name);
@@ -300,17 +308,24 @@ namespace {
 }
 const StructRepr* Target_GetStructRepr(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty)
 {
-    // TODO: Thread safety
     // Map of generic paths to struct representations.
-    static ::std::map<::HIR::TypeRef, ::std::unique_ptr<StructRepr>>  s_cache;
+    static ::std::unordered_map<::HIR::InternedType, ::std::unique_ptr<StructRepr>>  s_cache;
+    static ::std::mutex s_cache_lock;
 
-    auto it = s_cache.find(ty);
-    if( it != s_cache.end() )
+    auto key = ::HIR::InternedType::intern(ty);
     {
-        return it->second.get();
+        ::std::lock_guard<::std::mutex> lh { s_cache_lock };
+        auto it = s_cache.find(key);
+        if( it != s_cache.end() )
+        {
+            return it->second.get();
+        }
     }
 
-    auto ires = s_cache.insert(::std::make_pair( ty.clone(), make_struct_repr(sp, resolve, ty) ));
+    // NOTE: Generated without the lock held (it recurses), if another thread got there first its version is kept.
+    auto repr = make_struct_repr(sp, resolve, ty);
+    ::std::lock_guard<::std::mutex> lh { s_cache_lock };
+    auto ires = s_cache.insert(::std::make_pair( key, mv$(repr) ));
     return ires.first->second.get();
 }
 
@@ -957,17 +972,25 @@ namespace {
 }
 const TypeRepr* Target_GetTypeRepr(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty)
 {
-    // TODO: Thread safety
+    STATS_TIMER("Target_GetTypeRepr");
     // Map of generic types to type representations.
-    static ::std::map<::HIR::TypeRef, ::std::unique_ptr<TypeRepr>>  s_cache;
+    static ::std::unordered_map<::HIR::InternedType, ::std::unique_ptr<TypeRepr>>  s_cache;
+    static ::std::mutex s_cache_lock;
 
-    auto it = s_cache.find(ty);
-    if( it != s_cache.end() )
+    auto key = ::HIR::InternedType::intern(ty);
     {
-        return it->second.get();
+        ::std::lock_guard<::std::mutex> lh { s_cache_lock };
+        auto it = s_cache.find(key);
+        if( it != s_cache.end() )
+        {
+            return it->second.get();
+        }
     }
 
-    auto ires = s_cache.insert(::std::make_pair( ty.clone(), make_type_repr(sp, resolve, ty) ));
+    // NOTE: Generated without the lock held (it recurses), if another thread got there first its version is kept.
+    auto repr = make_type_repr(sp, resolve, ty);
+    ::std::lock_guard<::std::mutex> lh { s_cache_lock };
+    auto ires = s_cache.insert(::std::make_pair( key, mv$(repr) ));
     return ires.first->second.get();
 }
 const ::HIR::TypeRef& Target_GetInnerType(const Span& sp, const StaticTraitResolve& resolve, const TypeRepr& repr, size_t idx, const ::std::vector<size_t>& sub_fields, size_t ofs)
@@ -41,7 +41,7 @@ TransList_Static* TransList::add_static(::HIR::Path p)
 
 t_cb_generic Trans_Params::get_cb() const
 {
-    return monomorphise_type_get_cb(sp, &self_type, &pp_impl, &pp_method);
+    return monomorphise_type_get_cb(sp, self_type.is_valid() ? &*self_type : nullptr, &pp_impl, &pp_method);
 }
 ::HIR::Path Trans_Params::monomorph(const ::StaticTraitResolve& resolve, const ::HIR::Path& p) const
 {
@@ -9,7 +9,11 @@
 
 #include <hir/type.hpp>
 #include <hir/path.hpp>
+#include <hir/type_intern.hpp>
 #include <hir_typeck/common.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 
 class StaticTraitResolve;
 namespace HIR {
@@ -23,7 +27,7 @@ struct Trans_Params
     Span    sp;
     ::HIR::PathParams   pp_method;
     ::HIR::PathParams   pp_impl;
-    ::HIR::TypeRef  self_type;
+    ::HIR::InternedType self_type;
 
     Trans_Params() {}
     Trans_Params(const Span& sp):
@@ -68,13 +72,14 @@ public:
     TransList& operator=(TransList&&) = default;
     TransList& operator=(const TransList&) = delete;
 
-    ::std::map< ::HIR::Path, ::std::unique_ptr<TransList_Function> > m_functions;
-    ::std::map< ::HIR::Path, ::std::unique_ptr<TransList_Static> > m_statics;
-    ::std::map< ::HIR::Path, Trans_Params> m_vtables;
+    // NOTE: Hashed (iteration order isn't deterministic), use `sorted_entries` when the order affects output
+    ::std::unordered_map< ::HIR::Path, ::std::unique_ptr<TransList_Function> > m_functions;
+    ::std::unordered_map< ::HIR::Path, ::std::unique_ptr<TransList_Static> > m_statics;
+    ::std::unordered_map< ::HIR::Path, Trans_Params> m_vtables;
     /// Required type_id values
-    ::std::set< ::HIR::TypeRef> m_typeids;
+    ::std::unordered_set< ::HIR::TypeRef> m_typeids;
     /// Required struct/enum constructor impls
-    ::std::set< ::HIR::GenericPath> m_constructors;
+    ::std::unordered_set< ::HIR::GenericPath> m_constructors;
 
     // .second is `true` if this is a from a reference to the type
     ::std::vector< ::std::pair<::HIR::TypeRef, bool> >  m_types;
@@ -86,3 +91,25 @@ public:
     }
 };
 
+/// Entries of a hashed container, sorted by key (for deterministic iteration)
+template<typename K, typename V>
+::std::vector<const ::std::pair<const K, V>*> sorted_entries(const ::std::unordered_map<K, V>& m)
+{
+    ::std::vector<const ::std::pair<const K, V>*>   rv;
+    rv.reserve(m.size());
+    for(const auto& e : m)
+        rv.push_back(&e);
+    ::std::sort(rv.begin(), rv.end(), [](const auto* a, const auto* b){ return a->first < b->first; });
+    return rv;
+}
+template<typename K>
+::std::vector<const K*> sorted_entries(const ::std::unordered_set<K>& s)
+{
+    ::std::vector<const K*> rv;
+    rv.reserve(s.size());
+    for(const auto& e : s)
+        rv.push_back(&e);
+    ::std::sort(rv.begin(), rv.end(), [](const auto* a, const auto* b){ return *a < *b; });
+    return rv;
+}
+
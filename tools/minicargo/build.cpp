@@ -32,6 +32,12 @@ extern int _putenv_s(const char*, const char*);
 #endif
 #include <climits>
 #include <cassert>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <cstring>  // strlen
 #ifdef _WIN32
 # include <Windows.h>
 #else
@@ -59,17 +65,49 @@ extern int _putenv_s(const char*, const char*);
 # define HOST_TARGET "x86_64-unknown-linux-gnu"
 #endif
 
+#ifndef _WIN32
+/// Connection to a `mrustc --compile-server` process (see mrustc's `src/compile_server.cpp` for the protocol)
+class CompileServer
+{
+    pid_t   m_pid;
+    int m_to_server;
+    FILE*   m_from_server;
+
+    ::std::mutex    m_lock;
+    ::std::condition_variable   m_cv;
+    unsigned    m_next_id = 0;
+    bool    m_reader_active = false;
+    bool    m_failed = false;
+    ::std::map<unsigned, int>   m_results;
+
+public:
+    CompileServer(const ::helpers::path& compiler_path);
+    ~CompileServer();
+
+    /// Run the compiler with the given arguments, returns the exit status (or -1 if the server has died)
+    int run(const StringList& args, const StringListKV& env, const ::helpers::path& logfile);
+};
+#endif
+
 /// Class abstracting access to the compiler
 class Builder
 {
     BuildOptions    m_opts;
     ::helpers::path m_compiler_path;
+#ifndef _WIN32
+    ::std::unique_ptr<CompileServer>    m_compile_server;
+#endif
+    // Cache of file content hashes (see `get_file_hash`)
+#ifndef DISABLE_MULTITHREAD
+    mutable ::std::mutex    m_file_hash_lock;
+#endif
+    mutable ::std::map< ::std::string, uint64_t>    m_file_hashes;
 
 public:
     Builder(BuildOptions opts);
 
-    bool build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host) const;
-    bool build_library(const PackageManifest& manifest, bool is_for_host) const;
+    bool build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, bool* out_did_build=nullptr) const;
+    bool build_library(const PackageManifest& manifest, bool is_for_host, bool* out_did_build=nullptr) const;
     ::helpers::path build_build_script(const PackageManifest& manifest, bool is_for_host, bool* out_is_rebuilt) const;
 
 private:
@@ -79,6 +117,13 @@ private:
 
     ::helpers::path build_and_run_script(const PackageManifest& manifest, bool is_for_host) const;
 
+    /// Content hash of a file (zero if it can't be read)
+    uint64_t get_file_hash(const ::helpers::path& p) const;
+    /// Check the input record written by `save_inputs` (returns false if it's missing, or any input has changed)
+    bool check_inputs(const ::helpers::path& inputs_file, uint64_t flags_hash) const;
+    /// Save the hashes of all inputs (listed in mrustc's depfile) used to build an output
+    void save_inputs(const ::helpers::path& depfile, const ::helpers::path& inputs_file, uint64_t flags_hash) const;
+
     // If `is_for_host` and cross compiling, use a different directory
     // - TODO: Include the target arch in the output dir too?
     ::helpers::path get_output_dir(bool is_for_host) const {
@@ -133,6 +178,41 @@ public:
     }
 };
 
+/// FNV-1a hash (64-bit), `h` is the hash of any preceding data (or zero)
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t len)
+{
+    if( h == 0 )
+        h = 0xcbf29ce484222325ull;
+    const auto* p = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < len; i ++)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+/// Time taken to build each package in previous runs (stored in the output directory)
+struct BuildTimes
+{
+    ::std::map< ::std::string, double>  m_times;
+
+    void load(const ::helpers::path& p)
+    {
+        ::std::ifstream in(p.str());
+        ::std::string   key;
+        double  time;
+        while( in >> key >> time )
+            m_times[key] = time;
+    }
+    void save(const ::helpers::path& p) const
+    {
+        ::std::ofstream out(p.str());
+        for(const auto& e : m_times)
+            out << e.first << " " << e.second << "\n";
+    }
+};
+
 BuildList::BuildList(const PackageManifest& manifest, const BuildOptions& opts):
     m_root_manifest(manifest)
 {
@@ -258,13 +338,28 @@ BuildList::BuildList(const PackageManifest& manifest, const BuildOptions& opts):
 bool BuildList::build(BuildOptions opts, unsigned num_jobs)
 {
     bool include_build = !opts.build_script_overrides.is_valid();
+    auto times_file = opts.output_dir / "minicargo-times.txt";
     Builder builder { ::std::move(opts) };
+    auto build_start = ::std::chrono::steady_clock::now();
+
+    // Build times from previous runs, used to start the packages on the longest dependency chain first
+    BuildTimes  times;
+    times.load(times_file);
+    // NOTE: Host and target builds of a package are timed separately
+    auto get_time_key = [](const Entry& e) {
+        return ::format(e.package->name(), "-", e.package->version(), (e.is_host ? "-host" : ""));
+        };
 
     // Pre-count how many dependencies are remaining for each package
     struct BuildState
     {
         ::std::vector<unsigned> num_deps_remaining;
         ::std::vector<unsigned> build_queue;
+        /// Estimated time from starting this package to the end of the build (its cost plus the longest chain of
+        /// dependents)
+        ::std::vector<double>   priority;
+        /// Time taken to build each package in this run (negative if it wasn't built)
+        ::std::vector<double>   build_time;
 
         int complete_package(unsigned index, const ::std::vector<Entry>& list)
         {
@@ -289,12 +384,49 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         unsigned get_next()
         {
             assert(!this->build_queue.empty());
-            unsigned rv = this->build_queue.back();
-            this->build_queue.pop_back();
+            // Pick the package with the longest remaining chain (the most recently queued if equal)
+            auto best = this->build_queue.end() - 1;
+            for(auto it = this->build_queue.begin(); it != this->build_queue.end(); ++it)
+            {
+                if( this->priority[*it] > this->priority[*best] )
+                    best = it;
+            }
+            unsigned rv = *best;
+            this->build_queue.erase(best);
             return rv;
         }
     };
+    // Build a package, recording how long it took
+    auto build_one = [](const Builder& builder, const Entry& e, double& out_time)->bool {
+        auto start = ::std::chrono::steady_clock::now();
+        bool did_build = false;
+        bool rv = builder.build_library(*e.package, e.is_host, &did_build);
+        out_time = did_build ? ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - start).count() : -1.0;
+        return rv;
+        };
+    // Length (in seconds) of the longest chain of dependents starting at each package
+    // - Packages without a recorded time count as one second
+    auto get_chain_lengths = [&](const ::std::vector<double>& build_time) {
+        ::std::vector<double>   rv( m_list.size() );
+        // Dependents are always later in the list, so go backwards
+        for(size_t i = m_list.size(); i --; )
+        {
+            double cost = build_time[i];
+            if( cost < 0 )
+            {
+                auto it = times.m_times.find(get_time_key(m_list[i]));
+                cost = (it != times.m_times.end() ? it->second : 1.0);
+            }
+            double longest_dep = 0;
+            for(auto d : m_list[i].dependents)
+                longest_dep = ::std::max(longest_dep, rv[d]);
+            rv[i] = cost + longest_dep;
+        }
+        return rv;
+        };
     BuildState  state;
+    state.build_time.resize(m_list.size(), -1.0);
+    state.priority = get_chain_lengths(state.build_time);
     state.num_deps_remaining.reserve(m_list.size());
     for(const auto& e : m_list)
     {
@@ -388,7 +520,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
             }
         };
         struct H {
-            static void thread_body(unsigned my_idx, const ::std::vector<Entry>* list_p, Queue* queue_p, const Builder* builder)
+            static void thread_body(unsigned my_idx, const ::std::vector<Entry>* list_p, Queue* queue_p, const Builder* builder, bool (*build_one)(const Builder&, const Entry&, double&))
             {
                 const auto& list = *list_p;
                 auto& queue = *queue_p;
@@ -411,7 +543,8 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
                     }
 
                     DEBUG("Thread " << my_idx << ": Starting " << cur << " - " << list[cur].package->name());
-                    if( ! builder->build_library(*list[cur].package, list[cur].is_host) )
+                    double  build_time;
+                    if( ! build_one(*builder, list[cur], build_time) )
                     {
                         queue.failure = true;
                         queue.signal_all();
@@ -419,6 +552,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
                     else
                     {
                         ::std::lock_guard<::std::mutex> sl { queue.mutex };
+                        queue.state.build_time[cur] = build_time;
                         queue.num_active --;
                         int v = queue.state.complete_package(cur, list);
                         while(v--)
@@ -446,7 +580,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         DEBUG("Spawning " << num_jobs << " worker threads");
         for(unsigned i = 0; i < num_jobs; i++)
         {
-            threads.push_back(::std::thread(H::thread_body, i, &this->m_list, &queue, &builder));
+            threads.push_back(::std::thread(H::thread_body, i, &this->m_list, &queue, &builder, +build_one));
         }
 
         DEBUG("Poking jobs");
@@ -472,7 +606,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         {
             auto cur = state.get_next();
 
-            if( ! builder.build_library(*m_list[cur].package, m_list[cur].is_host) )
+            if( ! build_one(builder, m_list[cur], state.build_time[cur]) )
             {
                 return false;
             }
@@ -486,7 +620,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         {
             auto cur = state.get_next();
 
-            if( ! builder.build_library(*m_list[cur].package, m_list[cur].is_host) )
+            if( ! build_one(builder, m_list[cur], state.build_time[cur]) )
             {
                 return false;
             }
@@ -529,6 +663,50 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         }
     }
 
+    // Save the build times, and report the critical path (the longest chain of dependent packages)
+    // - Packages that weren't built this time use the time from previous builds
+    {
+        bool any_built = false;
+        for(size_t i = 0; i < m_list.size(); i ++)
+        {
+            if( state.build_time[i] >= 0 )
+            {
+                times.m_times[get_time_key(m_list[i])] = state.build_time[i];
+                any_built = true;
+            }
+        }
+        if( any_built )
+        {
+            times.save(times_file);
+
+            // The longest chain starts at the package with the largest chain length, then follows the dependent with
+            // the longest chain.
+            auto chain = get_chain_lengths(state.build_time);
+            size_t cur = ::std::max_element(chain.begin(), chain.end()) - chain.begin();
+            ::std::cout << "Critical path (" << chain[cur] << "s, build took "
+                << ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - build_start).count() << "s):";
+            for(;;)
+            {
+                const auto& e = m_list[cur];
+                double rest = 0;
+                size_t next = cur;
+                for(auto d : e.dependents)
+                {
+                    if( chain[d] > rest ) {
+                        rest = chain[d];
+                        next = d;
+                    }
+                }
+                ::std::cout << " " << e.package->name() << " (" << (chain[cur] - rest) << "s)";
+                if( next == cur )
+                    break;
+                ::std::cout << " ->";
+                cur = next;
+            }
+            ::std::cout << ::std::endl;
+        }
+    }
+
     // Now that all libraries are done, build the binaries (if present)
     return this->m_root_manifest.foreach_binaries([&](const auto& bin_target) {
         return builder.build_target(this->m_root_manifest, bin_target, /*is_for_host=*/false);
@@ -560,6 +738,15 @@ Builder::Builder(BuildOptions opts):
     minicargo_path.pop_component();
     m_compiler_path = (minicargo_path / "../../bin/mrustc").normalise();
 #endif
+
+    if( m_opts.use_compile_server )
+    {
+#ifdef _WIN32
+        ::std::cerr << "WARNING: --compile-server is not supported on this platform, ignoring" << ::std::endl;
+#else
+        m_compile_server.reset(new CompileServer(m_compiler_path));
+#endif
+    }
 }
 
 ::helpers::path Builder::get_crate_path(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, const char** crate_type, ::std::string* out_crate_suffix) const
@@ -597,44 +784,12 @@ Builder::Builder(BuildOptions opts):
     return outfile;
 }
 
-bool Builder::build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host) const
+bool Builder::build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, bool* out_did_build) const
 {
     const char* crate_type;
     ::std::string   crate_suffix;
     auto outfile = this->get_crate_path(manifest, target, is_for_host,  &crate_type, &crate_suffix);
 
-    // TODO: Determine if it needs re-running
-    // Rerun if:
-    // > `outfile` is missing
-    // > mrustc/minicargo is newer than `outfile`
-    // > build script has changed
-    // > any input file has changed (requires depfile from mrustc)
-    bool force_rebuild = false;
-    auto ts_result = Timestamp::for_file(outfile);
-    if( force_rebuild ) {
-        DEBUG("Building " << outfile << " - Force");
-    }
-    else if( ts_result == Timestamp::infinite_past() ) {
-        // Rebuild (missing)
-        DEBUG("Building " << outfile << " - Missing");
-    }
-    else if( !getenv("MINICARGO_IGNTOOLS") && ( ts_result < Timestamp::for_file(m_compiler_path) /*|| ts_result < Timestamp::for_file("bin/minicargo")*/ ) ) {
-        // Rebuild (older than mrustc/minicargo)
-        DEBUG("Building " << outfile << " - Older than mrustc ( " << ts_result << " < " << Timestamp::for_file(m_compiler_path) << ")");
-    }
-    else {
-        // TODO: Check dependencies. (from depfile)
-        // Don't rebuild (no need to)
-        DEBUG("Not building " << outfile << " - not out of date");
-        return true;
-    }
-
-    for(const auto& cmd : manifest.build_script_output().pre_build_commands)
-    {
-        // TODO: Run commands specified by build script (override)
-    }
-
-    ::std::cout << "BUILDING " << target.m_name << " from " << manifest.name() << " v" << manifest.version() << " with features [" << manifest.active_features() << "]" << ::std::endl;
     StringList  args;
     args.push_back(::helpers::path(manifest.manifest_path()).parent() / ::helpers::path(target.m_path));
     args.push_back("--crate-name"); args.push_back(target.m_name.c_str());
@@ -663,6 +818,25 @@ bool Builder::build_target(const PackageManifest& manifest, const PackageTarget&
     {
         args.push_back("-C"); args.push_back("codegen-type=monomir");
     }
+    if( m_opts.lto )
+    {
+        args.push_back("--lto");
+    }
+    switch( m_opts.pgo )
+    {
+    case BuildOptions::Pgo::None:
+        break;
+    case BuildOptions::Pgo::Generate:
+        args.push_back(format("--profile-generate=", m_opts.pgo_profile_dir));
+        break;
+    case BuildOptions::Pgo::Use:
+        args.push_back(format("--profile-use=", m_opts.pgo_profile_dir));
+        break;
+    }
+    if( m_opts.mono_cache_dir.is_valid() )
+    {
+        args.push_back("-C"); args.push_back(format("mono-cache=", m_opts.mono_cache_dir));
+    }
 
     args.push_back("-o"); args.push_back(outfile);
     args.push_back("-L"); args.push_back(this->get_output_dir(is_for_host).str());
@@ -727,10 +901,70 @@ bool Builder::build_target(const PackageManifest& manifest, const PackageTarget&
         }
     }
 
+    // Determine if it needs re-running
+    // Rerun if:
+    // > `outfile` is missing
+    // > mrustc has changed
+    // > the arguments/environment have changed (e.g. features, dependencies, build script output)
+    // > any input file (from mrustc's depfile, including dependency crates) has changed
+    // If there's no record of the inputs (e.g. built by an older minicargo), fall back to timestamps
+    uint64_t flags_hash = hash_bytes(0, "", 0);
+    for(const auto& a : args.get_vec())
+        flags_hash = hash_bytes(flags_hash, a, ::std::strlen(a) + 1);
+    for(auto kv : env)
+    {
+        flags_hash = hash_bytes(flags_hash, kv.first, ::std::strlen(kv.first) + 1);
+        flags_hash = hash_bytes(flags_hash, kv.second, ::std::strlen(kv.second) + 1);
+    }
+    auto inputs_file = outfile + ".inputs";
+    auto depfile = outfile + ".d";
+
+    bool force_rebuild = false;
+    auto ts_result = Timestamp::for_file(outfile);
+    if( force_rebuild ) {
+        DEBUG("Building " << outfile << " - Force");
+    }
+    else if( ts_result == Timestamp::infinite_past() ) {
+        // Rebuild (missing)
+        DEBUG("Building " << outfile << " - Missing");
+    }
+    else if( !(Timestamp::for_file(inputs_file) == Timestamp::infinite_past()) ) {
+        if( this->check_inputs(inputs_file, flags_hash) ) {
+            DEBUG("Not building " << outfile << " - inputs unchanged");
+            return true;
+        }
+        DEBUG("Building " << outfile << " - Inputs changed");
+    }
+    else if( !getenv("MINICARGO_IGNTOOLS") && ( ts_result < Timestamp::for_file(m_compiler_path) /*|| ts_result < Timestamp::for_file("bin/minicargo")*/ ) ) {
+        // Rebuild (older than mrustc/minicargo)
+        DEBUG("Building " << outfile << " - Older than mrustc ( " << ts_result << " < " << Timestamp::for_file(m_compiler_path) << ")");
+    }
+    else {
+        // Don't rebuild (no need to)
+        DEBUG("Not building " << outfile << " - not out of date");
+        return true;
+    }
+    if( out_did_build )
+        *out_did_build = true;
+
+    for(const auto& cmd : manifest.build_script_output().pre_build_commands)
+    {
+        // TODO: Run commands specified by build script (override)
+    }
+
+    ::std::cout << "BUILDING " << target.m_name << " from " << manifest.name() << " v" << manifest.version() << " with features [" << manifest.active_features() << "]" << ::std::endl;
+    // NOTE: Not part of the flags hash (only depends on `outfile`)
+    args.push_back("-C"); args.push_back(format("emit-depfile=", depfile));
+
+    // Remove the old input record first, so a failed build doesn't leave a stale one
+    remove(inputs_file.str().c_str());
     // TODO: If emitting command files (i.e. cross-compiling), concatenate the contents of `outfile + ".sh"` onto a
     // master file.
     // - Will probably want to do this as a final stage after building everything.
-    return this->spawn_process_mrustc(args, ::std::move(env), outfile + "_dbg.txt");
+    if( !this->spawn_process_mrustc(args, ::std::move(env), outfile + "_dbg.txt") )
+        return false;
+    this->save_inputs(depfile, inputs_file, flags_hash);
+    return true;
 }
 ::helpers::path Builder::build_build_script(const PackageManifest& manifest, bool is_for_host, bool* out_is_rebuilt) const
 {
@@ -874,7 +1108,7 @@ bool Builder::build_target(const PackageManifest& manifest, const PackageTarget&
     
     return out_file;
 }
-bool Builder::build_library(const PackageManifest& manifest, bool is_for_host) const
+bool Builder::build_library(const PackageManifest& manifest, bool is_for_host, bool* out_did_build) const
 {
     if( manifest.build_script() != "" )
     {
@@ -900,11 +1134,156 @@ bool Builder::build_library(const PackageManifest& manifest, bool is_for_host) c
         }
     }
 
-    return this->build_target(manifest, manifest.get_library(), is_for_host);
+    return this->build_target(manifest, manifest.get_library(), is_for_host, out_did_build);
+}
+uint64_t Builder::get_file_hash(const ::helpers::path& p) const
+{
+    // NOTE: Cached for the lifetime of the builder. Files are only hashed once they're final (dependency crates are
+    // only checked after they have been built).
+    {
+#ifndef DISABLE_MULTITHREAD
+        ::std::lock_guard<::std::mutex> lh { m_file_hash_lock };
+#endif
+        auto it = m_file_hashes.find(p.str());
+        if( it != m_file_hashes.end() )
+            return it->second;
+    }
+
+    uint64_t rv = 0;
+    ::std::ifstream is(p.str(), ::std::ios::binary);
+    if( is.good() )
+    {
+        rv = hash_bytes(0, "", 0);
+        char    buf[64*1024];
+        while( is.read(buf, sizeof(buf)) || is.gcount() > 0 )
+        {
+            rv = hash_bytes(rv, buf, static_cast<size_t>(is.gcount()));
+        }
+    }
+
+#ifndef DISABLE_MULTITHREAD
+    ::std::lock_guard<::std::mutex> lh { m_file_hash_lock };
+#endif
+    m_file_hashes[p.str()] = rv;
+    return rv;
+}
+// Input record format: One `<hash> <name>` line per input, where name is `:compiler`, `:flags` or a path
+bool Builder::check_inputs(const ::helpers::path& inputs_file, uint64_t flags_hash) const
+{
+    ::std::ifstream is(inputs_file.str());
+    ::std::string   line;
+    bool seen_flags = false;
+    while( ::std::getline(is, line) )
+    {
+        auto sp = line.find(' ');
+        if( sp == ::std::string::npos )
+            return false;
+        uint64_t hash = ::std::strtoull(line.c_str(), nullptr, 16);
+        auto name = line.substr(sp + 1);
+        if( name == ":compiler" )
+        {
+            if( !getenv("MINICARGO_IGNTOOLS") && hash != this->get_file_hash(m_compiler_path) ) {
+                DEBUG("Compiler changed");
+                return false;
+            }
+        }
+        else if( name == ":flags" )
+        {
+            if( hash != flags_hash ) {
+                DEBUG("Flags changed");
+                return false;
+            }
+            seen_flags = true;
+        }
+        else
+        {
+            if( hash != this->get_file_hash(name) ) {
+                DEBUG("Input " << name << " changed");
+                return false;
+            }
+        }
+    }
+    return seen_flags;
+}
+void Builder::save_inputs(const ::helpers::path& depfile, const ::helpers::path& inputs_file, uint64_t flags_hash) const
+{
+    // Depfile: `<output>: <input> <input> ...`, with make-style escapes (`\ `, `\#`, `$$`) and line continuations
+    ::std::ifstream is(depfile.str());
+    if( !is.good() )
+    {
+        DEBUG("No depfile " << depfile << ", can't record inputs");
+        return ;
+    }
+    ::std::vector< ::std::string>   tokens;
+    ::std::string   tok;
+    bool in_token = false;
+    for(int c; (c = is.get()) != EOF; )
+    {
+        if( c == '\\' && (is.peek() == ' ' || is.peek() == '#') ) {
+            c = is.get();
+        }
+        else if( c == '\\' && (is.peek() == '\n' || is.peek() == '\r') ) {
+            // Line continuation, the newline is then handled as a separator
+            continue ;
+        }
+        else if( c == '$' && is.peek() == '$' ) {
+            is.get();
+        }
+        else if( c == ' ' || c == '\t' || c == '\n' || c == '\r' ) {
+            if( in_token )
+                tokens.push_back(::std::move(tok));
+            tok.clear();
+            in_token = false;
+            continue ;
+        }
+        tok.push_back(static_cast<char>(c));
+        in_token = true;
+    }
+    if( in_token )
+        tokens.push_back(::std::move(tok));
+
+    ::std::vector< ::std::string>   inputs;
+    bool seen_target = false;
+    for(auto& t : tokens)
+    {
+        if( !seen_target ) {
+            seen_target = (t.back() == ':');
+            continue ;
+        }
+        inputs.push_back(::std::move(t));
+    }
+
+    ::std::ofstream os(inputs_file.str());
+    os << ::std::hex;
+    os << this->get_file_hash(m_compiler_path) << " :compiler\n";
+    os << flags_hash << " :flags\n";
+    for(const auto& i : inputs)
+    {
+        os << this->get_file_hash(i) << " " << i << "\n";
+    }
 }
 bool Builder::spawn_process_mrustc(const StringList& args, StringListKV env, const ::helpers::path& logfile) const
 {
     //env.push_back("MRUSTC_DEBUG", "");
+#ifndef _WIN32
+    if( m_compile_server )
+    {
+        mkdir(static_cast<::std::string>(logfile.parent()).c_str(), 0755);
+        Debug_Print([&](auto& os){
+            os << "Calling (server) " << m_compiler_path;
+            for(const auto& p : args.get_vec())
+                os << " " << p;
+            });
+        int status = m_compile_server->run(args, env, logfile);
+        if( status != 0 )
+        {
+            DEBUG("Compiler exited with non-zero exit status " << status);
+            DEBUG("See " << logfile << " for the compiler output");
+            return false;
+        }
+        return true;
+    }
+#endif
     return spawn_process(m_compiler_path.str().c_str(), args, env, logfile);
 }
 bool Builder::spawn_process(const char* exe_name, const StringList& args, const StringListKV& env, const ::helpers::path& logfile) const
@@ -1030,6 +1409,117 @@ bool Builder::spawn_process(const char* exe_name, const StringList& args, const
     return true;
 }
 
+#ifndef _WIN32
+CompileServer::CompileServer(const ::helpers::path& compiler_path)
+{
+    int to_server[2];
+    int from_server[2];
+    if( pipe(to_server) != 0 || pipe(from_server) != 0 )
+    {
+        perror("pipe");
+        throw ::std::runtime_error("Unable to create pipes for compile server");
+    }
+    // Our ends of the pipes must not leak into other spawned processes (the server would never see EOF)
+    fcntl(to_server[1], F_SETFD, FD_CLOEXEC);
+    fcntl(from_server[0], F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t  fa;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, to_server[0], 0);
+    posix_spawn_file_actions_adddup2(&fa, from_server[1], 1);
+    posix_spawn_file_actions_addclose(&fa, to_server[0]);
+    posix_spawn_file_actions_addclose(&fa, from_server[1]);
+
+    auto compiler_str = compiler_path.str();
+    const char* argv[] = { compiler_str.c_str(), "--compile-server", nullptr };
+    extern char **environ;
+    if( posix_spawn(&m_pid, compiler_str.c_str(), &fa, /*attr=*/nullptr, (char* const*)argv, environ) != 0 )
+    {
+        perror("posix_spawn");
+        posix_spawn_file_actions_destroy(&fa);
+        throw ::std::runtime_error("Unable to spawn compile server");
+    }
+    posix_spawn_file_actions_destroy(&fa);
+    close(to_server[0]);
+    close(from_server[1]);
+
+    m_to_server = to_server[1];
+    m_from_server = fdopen(from_server[0], "r");
+    DEBUG("Started compile server, pid " << m_pid);
+}
+CompileServer::~CompileServer()
+{
+    // Closing the job pipe tells the server to exit (once all jobs are complete)
+    close(m_to_server);
+    int status;
+    waitpid(m_pid, &status, 0);
+    fclose(m_from_server);
+}
+int CompileServer::run(const StringList& args, const StringListKV& env, const ::helpers::path& logfile)
+{
+    char    cwd[1024];
+    if( !getcwd(cwd, sizeof(cwd)) )
+        cwd[0] = '\0';
+
+    ::std::unique_lock<::std::mutex>    lh { m_lock };
+    if( m_failed )
+        return -1;
+    unsigned id = m_next_id ++;
+
+    ::std::string   job;
+    auto push = [&](const ::std::string& s) { job += s; job += '\0'; };
+    push(::format(id));
+    push(cwd);
+    push(logfile.str());
+    for(const auto& a : args.get_vec())
+        push(a);
+    push("");
+    for(auto kv : env)
+        push(::format(kv.first, "=", kv.second));
+    push("");
+
+    for(size_t ofs = 0; ofs < job.size(); )
+    {
+        auto rv = write(m_to_server, job.data() + ofs, job.size() - ofs);
+        if( rv < 0 )
+        {
+            perror("write");
+            m_failed = true;
+            m_cv.notify_all();
+            return -1;
+        }
+        ofs += rv;
+    }
+
+    // Wait for the result, one thread at a time reads results (for any job) from the server
+    while( m_results.count(id) == 0 )
+    {
+        if( m_failed )
+            return -1;
+        if( m_reader_active )
+        {
+            m_cv.wait(lh);
+            continue ;
+        }
+        m_reader_active = true;
+        lh.unlock();
+        unsigned    res_id;
+        int res_status;
+        bool ok = fscanf(m_from_server, "%u %d", &res_id, &res_status) == 2;
+        lh.lock();
+        m_reader_active = false;
+        if( ok )
+            m_results[res_id] = res_status;
+        else
+            m_failed = true;
+        m_cv.notify_all();
+    }
+    int rv = m_results[id];
+    m_results.erase(id);
+    return rv;
+}
+#endif
+
 Timestamp Timestamp::for_file(const ::helpers::path& path)
 {
 #if _WIN32
@@ -14,6 +14,16 @@ struct BuildOptions
     ::std::vector<::helpers::path>  lib_search_dirs;
     bool emit_mmir = false;
     const char* target_name = nullptr;	// if null, host is used
+    bool use_compile_server = false;    // Send compile jobs to a `mrustc --compile-server` process
+    bool lto = false;   // Pass `--lto` to mrustc for every crate
+    // Profile-guided optimisation mode, profiles are written to/read from `pgo_profile_dir` (see `--pgo-train`)
+    enum class Pgo {
+        None,
+        Generate,
+        Use,
+    } pgo = Pgo::None;
+    ::helpers::path pgo_profile_dir;
+    ::helpers::path mono_cache_dir; // If set, passed to mrustc as `-C mono-cache=<dir>`
 };
 
 class BuildList
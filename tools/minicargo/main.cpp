@@ -6,12 +6,20 @@
  */
 #include <iostream>
 #include <cstring>  // strcmp
+#include <cstdlib>  // system
 #include <map>
 #include "debug.h"
 #include "manifest.h"
 #include "helpers.h"
 #include "repository.h"
 #include "build.h"
+#if _WIN32
+# include <Windows.h>
+#else
+# include <dirent.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
 
 struct ProgramOptions
 {
@@ -39,6 +47,18 @@ struct ProgramOptions
     // Number of build jobs to run at a time
     unsigned build_jobs = 1;
 
+    // Run the compiler as a persistent server (keeps loaded crates between packages)
+    bool use_compile_server = false;
+
+    // Link-time optimisation (all crates are compiled with it, so the final link can optimise across them)
+    bool lto = false;
+
+    // Profile-guided optimisation: build instrumented, run this command to record a profile, then rebuild using it
+    const char* pgo_train_command = nullptr;
+
+    // Directory for the compiler's cache of monomorphised functions (shared between all packages built)
+    const char* mono_cache_dir = nullptr;
+
     // Pause for user input before quitting (useful for MSVC debugging)
     bool pause_before_quit = false;
 
@@ -47,6 +67,50 @@ struct ProgramOptions
     void help() const;
 };
 
+/// Delete everything inside a directory (leaving the directory itself, if it exists)
+static void remove_dir_contents(const ::helpers::path& dir)
+{
+#if _WIN32
+    WIN32_FIND_DATA find_data;
+    HANDLE find_handle = FindFirstFile( (dir / "*").str().c_str(), &find_data );
+    if( find_handle == INVALID_HANDLE_VALUE )
+        return ;
+    do
+    {
+        if( ::std::strcmp(find_data.cFileName, ".") == 0 || ::std::strcmp(find_data.cFileName, "..") == 0 )
+            continue ;
+        auto p = dir / find_data.cFileName;
+        if( find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) {
+            remove_dir_contents(p);
+            RemoveDirectory(p.str().c_str());
+        }
+        else {
+            DeleteFile(p.str().c_str());
+        }
+    } while( FindNextFile(find_handle, &find_data) );
+    FindClose(find_handle);
+#else
+    auto* dp = opendir(dir.str().c_str());
+    if( dp == nullptr )
+        return ;
+    while( const auto* dent = readdir(dp) )
+    {
+        if( ::std::strcmp(dent->d_name, ".") == 0 || ::std::strcmp(dent->d_name, "..") == 0 )
+            continue ;
+        auto p = dir / dent->d_name;
+        struct stat s;
+        if( lstat(p.str().c_str(), &s) == 0 && S_ISDIR(s.st_mode) ) {
+            remove_dir_contents(p);
+            rmdir(p.str().c_str());
+        }
+        else {
+            unlink(p.str().c_str());
+        }
+    }
+    closedir(dp);
+#endif
+}
+
 int main(int argc, const char* argv[])
 {
     ProgramOptions  opts;
@@ -89,12 +153,39 @@ int main(int argc, const char* argv[])
         build_opts.lib_search_dirs.reserve(opts.lib_search_dirs.size());
         build_opts.emit_mmir = opts.emit_mmir;
         build_opts.target_name = opts.target;
+        build_opts.use_compile_server = opts.use_compile_server;
+        build_opts.lto = opts.lto;
+        if( opts.mono_cache_dir )
+            build_opts.mono_cache_dir = ::helpers::path(opts.mono_cache_dir);
         for(const auto* d : opts.lib_search_dirs)
             build_opts.lib_search_dirs.push_back( ::helpers::path(d) );
         Debug_SetPhase("Enumerate Build");
         auto build_list = BuildList(m, build_opts);
         Debug_SetPhase("Run Build");
-        if( !build_list.build(::std::move(build_opts), opts.build_jobs) )
+        bool ok = true;
+        if( opts.pgo_train_command )
+        {
+            // NOTE: Absolute, as the profile is written by the training run (which may be in another directory)
+            build_opts.pgo_profile_dir = (build_opts.output_dir / "pgo-profile").to_absolute();
+            // Profiles left by an earlier training run would be merged into the new one (even if the code has changed)
+            remove_dir_contents(build_opts.pgo_profile_dir);
+            auto gen_opts = build_opts;
+            gen_opts.pgo = BuildOptions::Pgo::Generate;
+            ok = build_list.build(::std::move(gen_opts), opts.build_jobs);
+            if( ok )
+            {
+                ::std::cout << "Running PGO training command - " << opts.pgo_train_command << ::std::endl;
+                int ec = system(opts.pgo_train_command);
+                if( ec != 0 )
+                {
+                    ::std::cerr << "PGO training command failed (exit code " << ec << ")" << ::std::endl;
+                    ok = false;
+                }
+            }
+            // The final build's flags differ from the instrumented build's, so every crate is rebuilt
+            build_opts.pgo = BuildOptions::Pgo::Use;
+        }
+        if( !ok || !build_list.build(::std::move(build_opts), opts.build_jobs) )
         {
             ::std::cerr << "BUILD FAILED" << ::std::endl;
             if(opts.pause_before_quit) {
@@ -231,6 +322,26 @@ int ProgramOptions::parse(int argc, const char* argv[])
                 }
                 this->target = argv[++i];
             }
+            else if( ::std::strcmp(arg, "--compile-server") == 0 ) {
+                this->use_compile_server = true;
+            }
+            else if( ::std::strcmp(arg, "--lto") == 0 ) {
+                this->lto = true;
+            }
+            else if( ::std::strcmp(arg, "--pgo-train") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->pgo_train_command = argv[++i];
+            }
+            else if( ::std::strcmp(arg, "--mono-cache") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->mono_cache_dir = argv[++i];
+            }
             else if( ::std::strcmp(arg, "--pause") == 0 ) {
                 this->pause_before_quit = true;
             }
@@ -268,6 +379,12 @@ void ProgramOptions::help() const
         << "--script-overrides <dir> : Directory containing <package>.txt files containing the build script output\n"
         << "--vendor-dir <dir>       : Directory containing vendored packages (from `cargo vendor`)\n"
         << "--output-dir,-o <dir>    : Specify the compiler output directory\n"
+        << "--compile-server         : Run compile jobs via a single `mrustc --compile-server` (caches loaded crates)\n"
+        << "--lto                    : Build with link-time optimisation (allows inlining across crates)\n"
+        << "--pgo-train <command>    : Profile-guided build, run <command> (e.g. a benchmark of the built binary) with an\n"
+        << "                           instrumented build, then rebuild using the recorded profile\n"
+        << "--mono-cache <dir>       : Share monomorphised functions between crates (and builds) through this directory\n"
+        << "                           (entries are never evicted, clear the directory to reclaim space)\n"
         << "-L <dir>                 : Search for pre-built crates (e.g. libstd) in the specified directory\n"
         << "-j <count>               : Run at most <count> build tasks at once (default is to run only one)\n"
         << "-n                       : Don't build any packages, just list the packages that would be built\n"
@@ -7,10 +7,18 @@
 #include <vector>
 #include <fstream>
 #include <cctype>   // std::isblank
+#include <cstring>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include "../minicargo/debug.h"
 #include "../minicargo/path.h"
 #ifdef _WIN32
 # include <Windows.h>
+# include <Psapi.h>     // GetProcessMemoryInfo
+# pragma comment(lib, "psapi.lib")
 # define MRUSTC_PATH    "x64\\Release\\mrustc.exe"
 #else
 # include <sys/types.h>
@@ -20,6 +28,8 @@
 # include <spawn.h>
 # include <fcntl.h> // O_*
 # include <sys/wait.h>  // waitpid
+# include <sys/resource.h>  // wait4/rusage
+# include <signal.h>    // kill
 # define MRUSTC_PATH    "./bin/mrustc"
 #endif
 #include <algorithm>
@@ -35,6 +45,13 @@ struct Options
     const char* exceptions_file = nullptr;
     bool fail_fast = false;
 
+    /// Number of tests to run at once
+    unsigned num_jobs = 1;
+    /// Time limit for each compiler/test invocation, in seconds (zero for no limit)
+    unsigned timeout = 0;
+    /// Number of entries in the slowest test/regression reports
+    unsigned report_count = 10;
+
     int parse(int argc, const char* argv[]);
 
     void usage_short() const;
@@ -87,9 +104,53 @@ struct Timestamp
     }
 };
 
-bool run_executable(const ::helpers::path& file, const ::std::vector<const char*>& args, const ::helpers::path& outfile);
+/// Outcome of a single test
+enum class TestResult
+{
+    Ok,
+    CompileFail,
+    RunFail,
+};
+
+/// Resource usage of a single process
+struct ProcessStats
+{
+    /// Wall-clock time, in seconds
+    double  time = 0;
+    /// Peak resident memory, in KiB
+    uint64_t    peak_memory_kb = 0;
+};
+
+/// Measurements of one test (compiler stats include auxiliary crates)
+struct TestTimes
+{
+    ProcessStats    compile;
+    ProcessStats    run;
+
+    double total_time() const {
+        return compile.time + run.time;
+    }
+};
+
+/// Per-test measurements from previous runs (stored in the output directory), used for reports and to start the
+/// longest tests first
+struct TimingHistory
+{
+    ::std::map< ::std::string, TestTimes>   m_times;
+
+    void load(const ::helpers::path& p);
+    void save(const ::helpers::path& p) const;
+
+    /// Returns a negative value if the test hasn't been timed
+    double get(const ::std::string& name) const {
+        auto it = m_times.find(name);
+        return it != m_times.end() ? it->second.total_time() : -1.0;
+    }
+};
+
+bool run_executable(const ::helpers::path& file, const ::std::vector<const char*>& args, const ::helpers::path& outfile, unsigned timeout=0, ProcessStats* out_stats=nullptr);
 
-bool run_compiler(const ::helpers::path& source_file, const ::helpers::path& output, const ::std::vector<::std::string>& extra_flags, ::helpers::path libdir={}, bool is_dep=false)
+bool run_compiler(const ::helpers::path& source_file, const ::helpers::path& output, const ::std::vector<::std::string>& extra_flags, ::helpers::path libdir={}, bool is_dep=false, unsigned timeout=0, ProcessStats* out_stats=nullptr)
 {
     ::std::vector<const char*>  args;
     args.push_back("mrustc");
@@ -121,7 +182,159 @@ bool run_compiler(const ::helpers::path& source_file, const ::helpers::path& out
     for(const auto& s : extra_flags)
         args.push_back(s.c_str());
 
-    return run_executable(MRUSTC_PATH, args, logfile);
+    return run_executable(MRUSTC_PATH, args, logfile, timeout, out_stats);
+}
+
+/// Print the slowest tests from this run, and the biggest slowdowns compared to the previous run
+void print_timing_report(const Options& opts, const TimingHistory& history, const TimingHistory& prev_history, const ::std::vector< ::std::string>& measured)
+{
+    if( measured.empty() || opts.report_count == 0 )
+        return ;
+    auto fmt_kb = [](uint64_t kb)->::std::string {
+        return kb >= 10*1024 ? ::format(kb / 1024, "MiB") : ::format(kb, "KiB");
+        };
+    auto fmt_time = [](double t)->::std::string {
+        ::std::stringstream ss;
+        ss.precision(2);
+        ss << ::std::fixed << t << "s";
+        return ss.str();
+        };
+
+    ::std::vector<const ::std::string*> slowest;
+    for(const auto& name : measured)
+        slowest.push_back(&name);
+    ::std::sort(slowest.begin(), slowest.end(), [&](const auto* a, const auto* b) {
+        return history.m_times.at(*a).total_time() > history.m_times.at(*b).total_time();
+        });
+    if( slowest.size() > opts.report_count )
+        slowest.resize(opts.report_count);
+    ::std::cout << "SLOWEST TESTS" << ::std::endl;
+    for(const auto* name : slowest)
+    {
+        const auto& t = history.m_times.at(*name);
+        ::std::cout << "  " << *name << ": " << fmt_time(t.total_time())
+            << " (compile " << fmt_time(t.compile.time) << " " << fmt_kb(t.compile.peak_memory_kb)
+            << ", run " << fmt_time(t.run.time) << " " << fmt_kb(t.run.peak_memory_kb) << ")" << ::std::endl;
+    }
+
+    // Regressions: Tests that got slower (by time) or bigger (by compiler memory usage)
+    // - Ignores changes of less than 10% (or 0.1s/1MiB), which are usually just noise
+    struct Regression {
+        const ::std::string* name;
+        double  old_time, new_time;
+        uint64_t    old_kb, new_kb;
+        double time_ratio() const {
+            return (new_time - old_time > 0.1 && old_time > 0) ? new_time / old_time : 1.0;
+        }
+        double memory_ratio() const {
+            return (new_kb > old_kb + 1024 && old_kb > 0) ? double(new_kb) / double(old_kb) : 1.0;
+        }
+        double score() const {
+            return ::std::max(time_ratio(), memory_ratio());
+        }
+    };
+    ::std::vector<Regression>   regressions;
+    for(const auto& name : measured)
+    {
+        auto it = prev_history.m_times.find(name);
+        if( it == prev_history.m_times.end() )
+            continue ;
+        const auto& old_t = it->second;
+        const auto& new_t = history.m_times.at(name);
+        Regression  r { &name, old_t.total_time(), new_t.total_time(), old_t.compile.peak_memory_kb, new_t.compile.peak_memory_kb };
+        if( r.score() > 1.1 )
+            regressions.push_back(r);
+    }
+    ::std::sort(regressions.begin(), regressions.end(), [](const auto& a, const auto& b){ return a.score() > b.score(); });
+    if( regressions.size() > opts.report_count )
+        regressions.resize(opts.report_count);
+    if( !regressions.empty() )
+    {
+        ::std::cout << "BIGGEST REGRESSIONS (vs last run)" << ::std::endl;
+        for(const auto& r : regressions)
+        {
+            ::std::cout << "  " << *r.name << ": " << fmt_time(r.old_time) << " -> " << fmt_time(r.new_time)
+                << ", compiler memory " << fmt_kb(r.old_kb) << " -> " << fmt_kb(r.new_kb) << ::std::endl;
+        }
+    }
+}
+
+/// What `run_test` did (steps that were skipped because their output was up to date aren't measured)
+struct TestRunInfo
+{
+    bool    did_compile = false;
+    bool    did_run = false;
+    TestTimes   times;
+};
+
+/// Build (if out of date) and run a single test
+TestResult run_test(const Options& opts, const TestDesc& test, const ::helpers::path& input_path, const ::helpers::path& outdir, const Timestamp& compiler_ts, TestRunInfo& out_info)
+{
+    out_info = TestRunInfo();
+    auto add_compile_stats = [&](const ProcessStats& ps) {
+        out_info.times.compile.time += ps.time;
+        out_info.times.compile.peak_memory_kb = ::std::max(out_info.times.compile.peak_memory_kb, ps.peak_memory_kb);
+        };
+    auto depdir = outdir / "deps-" + test.m_name.c_str();
+    auto outfile = outdir / test.m_name + ".exe";
+
+    auto test_output_ts = Timestamp::for_file(outfile);
+    if( test_output_ts == Timestamp::infinite_past() || test_output_ts < compiler_ts )
+    {
+        out_info.did_compile = true;
+        for(const auto& file : test.m_pre_build)
+        {
+#ifdef _WIN32
+            CreateDirectoryA(depdir.str().c_str(), NULL);
+#else
+            mkdir(depdir.str().c_str(), 0755);
+#endif
+            auto infile = input_path / "auxiliary" / file;
+            ProcessStats    ps;
+            bool ok = run_compiler(infile, depdir, {}, depdir, true, opts.timeout, &ps);
+            add_compile_stats(ps);
+            if( !ok )
+            {
+                DEBUG("COMPILE FAIL " << infile << " (dep of " << test.m_name << ")");
+                return TestResult::CompileFail;
+            }
+        }
+
+        ProcessStats    ps;
+        bool ok = run_compiler(test.m_path, outfile, test.m_extra_flags, depdir, false, opts.timeout, &ps);
+        add_compile_stats(ps);
+        if( !ok )
+        {
+            DEBUG("COMPILE FAIL " << test.m_name);
+            return TestResult::CompileFail;
+        }
+        test_output_ts = Timestamp::for_file(outfile);
+    }
+    // - Run the test
+    auto run_out_file = outdir / test.m_name + ".out";
+    if( Timestamp::for_file(run_out_file) < test_output_ts )
+    {
+        out_info.did_run = true;
+        if( !run_executable(outfile, { outfile.str().c_str() }, run_out_file, opts.timeout, &out_info.times.run) )
+        {
+            DEBUG("RUN FAIL " << test.m_name);
+            return TestResult::RunFail;
+        }
+    }
+    else
+    {
+        if( opts.debug_level > 0 )
+            DEBUG("Unchanged " << test.m_name);
+    }
+    return TestResult::Ok;
+}
+
+// Debug output of the current thread goes here instead of stdout (when set), so output from parallel tests isn't
+// interleaved.
+static thread_local ::std::ostream* t_debug_output = nullptr;
+static ::std::ostream& debug_output_stream()
+{
+    return t_debug_output ? *t_debug_output : ::std::cout;
 }
 
 int main(int argc, const char* argv[])
@@ -282,6 +495,8 @@ int main(int argc, const char* argv[])
         unsigned n_cfail = 0;
         unsigned n_fail = 0;
         unsigned n_ok = 0;
+
+        ::std::vector<const TestDesc*>  to_run;
         for(const auto& test : tests)
         {
             if( !opts.test_list.empty() && ::std::find(opts.test_list.begin(), opts.test_list.end(), test.m_name) == opts.test_list.end() )
@@ -303,73 +518,121 @@ int main(int argc, const char* argv[])
                 n_skip ++;
                 continue ;
             }
+            to_run.push_back(&test);
+        }
 
-            //DEBUG(">> " << test.m_name);
-            auto depdir = outdir / "deps-" + test.m_name.c_str();
-            auto outfile = outdir / test.m_name + ".exe";
+        auto history_file = outdir / "testrunner-times.txt";
+        TimingHistory   history;
+        history.load(history_file);
+        const TimingHistory prev_history = history;
+        // Tests measured in this run
+        ::std::vector< ::std::string>   measured;
+
+        struct RunState {
+            TestResult  result = TestResult::Ok;
+            TestRunInfo info;
+            bool    complete = false;
+            ::std::stringstream log;
+        };
+        ::std::vector<RunState> states( to_run.size() );
+        auto run_one = [&](size_t idx) {
+            states[idx].result = run_test(opts, *to_run[idx], input_path, outdir, compiler_ts, states[idx].info);
+            };
+        // Tally a completed test, returns false if the run should stop
+        auto report = [&](size_t idx)->bool {
+            const auto& st = states[idx];
+            if( st.info.did_compile || st.info.did_run )
+            {
+                auto& ent = history.m_times[to_run[idx]->m_name];
+                if( st.info.did_compile )
+                    ent.compile = st.info.times.compile;
+                if( st.info.did_run )
+                    ent.run = st.info.times.run;
+                measured.push_back(to_run[idx]->m_name);
+            }
+            switch(st.result)
+            {
+            case TestResult::Ok:            n_ok ++;    break;
+            case TestResult::CompileFail:   n_cfail ++; break;
+            case TestResult::RunFail:       n_fail ++;  break;
+            }
+            return st.result == TestResult::Ok || !opts.fail_fast;
+            };
 
-            auto test_output_ts = Timestamp::for_file(outfile);
-            if( test_output_ts == Timestamp::infinite_past() || test_output_ts < compiler_ts )
+        bool stopped = false;
+        if( opts.num_jobs <= 1 )
+        {
+            for(size_t i = 0; i < to_run.size() && !stopped; i ++)
             {
-                bool pre_build_failed = false;
-                for(const auto& file : test.m_pre_build)
+                run_one(i);
+                stopped = !report(i);
+            }
+        }
+        else
+        {
+            // Start the slowest tests (from the last run) first, so a long test doesn't end up running alone at the
+            // end. Tests without a recorded time go first (they could be anything).
+            ::std::vector<size_t>   order;
+            for(size_t i = 0; i < to_run.size(); i ++)
+                order.push_back(i);
+            ::std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                double ta = history.get(to_run[a]->m_name);
+                double tb = history.get(to_run[b]->m_name);
+                if( (ta < 0) != (tb < 0) )
+                    return ta < 0;
+                return ta > tb;
+                });
+
+            ::std::mutex    lock;
+            ::std::condition_variable   cv;
+            size_t  next_job = 0;
+            bool    stop_requested = false;
+            auto worker = [&]() {
+                for(;;)
                 {
-#ifdef _WIN32
-                    CreateDirectoryA(depdir.str().c_str(), NULL);
-#else
-                    mkdir(depdir.str().c_str(), 0755);
-#endif
-                    auto infile = input_path / "auxiliary" / file;
-                    if( !run_compiler(infile, depdir, {}, depdir, true) )
+                    size_t idx;
                     {
-                        DEBUG("COMPILE FAIL " << infile << " (dep of " << test.m_name << ")");
-                        n_cfail ++;
-                        pre_build_failed = true;
-                        break;
+                        ::std::lock_guard<::std::mutex> lh { lock };
+                        if( stop_requested || next_job == order.size() )
+                            break;
+                        idx = order[next_job++];
                     }
+                    t_debug_output = &states[idx].log;
+                    run_one(idx);
+                    t_debug_output = nullptr;
+                    {
+                        ::std::lock_guard<::std::mutex> lh { lock };
+                        states[idx].complete = true;
+                    }
+                    cv.notify_all();
                 }
-                if( pre_build_failed )
-                {
-                    if( opts.fail_fast )
-                        return 1;
-                    else
-                        continue;
-                }
+                };
+            ::std::vector<::std::thread>    workers;
+            for(unsigned i = 0; i < ::std::min<size_t>(opts.num_jobs, to_run.size()); i ++)
+                workers.push_back(::std::thread(worker));
 
-                auto compile_logfile = outdir / test.m_name + "-build.log";
-                if( !run_compiler(test.m_path, outfile, test.m_extra_flags, depdir) )
-                {
-                    DEBUG("COMPILE FAIL " << test.m_name);
-                    n_cfail ++;
-                    if( opts.fail_fast )
-                        return 1;
-                    else
-                        continue;
-                }
-                test_output_ts = Timestamp::for_file(outfile);
-            }
-            // - Run the test
-            auto run_out_file = outdir / test.m_name + ".out";
-            if( Timestamp::for_file(run_out_file) < test_output_ts )
+            // Report results in name order (same output as a serial run)
+            for(size_t i = 0; i < to_run.size() && !stopped; i ++)
             {
-                if( !run_executable(outfile, { outfile.str().c_str() }, run_out_file) )
                 {
-                    DEBUG("RUN FAIL " << test.m_name);
-                    n_fail ++;
-                    if( opts.fail_fast )
-                        return 1;
-                    else
-                        continue;
+                    ::std::unique_lock<::std::mutex> lh { lock };
+                    cv.wait(lh, [&](){ return states[i].complete; });
                 }
+                ::std::cout << states[i].log.str() << ::std::flush;
+                stopped = !report(i);
             }
-            else
             {
-                if( opts.debug_level > 0 )
-                    DEBUG("Unchanged " << test.m_name);
+                ::std::lock_guard<::std::mutex> lh { lock };
+                stop_requested = true;
             }
-
-            n_ok ++;
+            for(auto& t : workers)
+                t.join();
         }
+        history.save(history_file);
+        if( stopped )
+            return 1;
+
+        print_timing_report(opts, history, prev_history, measured);
 
         ::std::cout << "TESTS COMPLETED" << ::std::endl;
         ::std::cout << n_ok << " passed, " << n_fail << " failed, " << n_cfail << " errored, " << n_skip << " skipped" << ::std::endl;
@@ -416,6 +679,13 @@ int Options::parse(int argc, const char* argv[])
             case 'v':
                 this->debug_level += 1;
                 break;
+            case 'j':
+                if( i+1 == argc ) {
+                    this->usage_short();
+                    return 1;
+                }
+                this->num_jobs = ::std::strtoul(argv[++i], nullptr, 10);
+                break;
 
             default:
                 this->usage_short();
@@ -457,6 +727,22 @@ int Options::parse(int argc, const char* argv[])
             {
                 this->fail_fast = true;
             }
+            else if( 0 == ::std::strcmp(arg, "--report-count") )
+            {
+                if( i+1 == argc ) {
+                    this->usage_short();
+                    return 1;
+                }
+                this->report_count = ::std::strtoul(argv[++i], nullptr, 10);
+            }
+            else if( 0 == ::std::strcmp(arg, "--timeout") )
+            {
+                if( i+1 == argc ) {
+                    this->usage_short();
+                    return 1;
+                }
+                this->timeout = ::std::strtoul(argv[++i], nullptr, 10);
+            }
             else
             {
                 this->usage_short();
@@ -475,8 +761,15 @@ void Options::usage_full() const
 }
 
 ///
-bool run_executable(const ::helpers::path& exe_name, const ::std::vector<const char*>& args, const ::helpers::path& outfile)
+bool run_executable(const ::helpers::path& exe_name, const ::std::vector<const char*>& args, const ::helpers::path& outfile, unsigned timeout, ProcessStats* out_stats)
 {
+    auto start_time = ::std::chrono::steady_clock::now();
+    auto set_stats = [&](uint64_t peak_memory_kb) {
+        if( out_stats ) {
+            out_stats->time = ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - start_time).count();
+            out_stats->peak_memory_kb = peak_memory_kb;
+        }
+        };
 #ifdef _WIN32
     ::std::stringstream cmdline;
     for (const auto& arg : args)
@@ -502,7 +795,23 @@ bool run_executable(const ::helpers::path& exe_name, const ::std::vector<const c
     PROCESS_INFORMATION pi = { 0 };
     CreateProcessA(exe_name.str().c_str(), (LPSTR)cmdline_str.c_str(), NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi);
     CloseHandle(si.hStdOutput);
-    WaitForSingleObject(pi.hProcess, INFINITE);
+    bool timed_out = (WaitForSingleObject(pi.hProcess, timeout > 0 ? timeout * 1000 : INFINITE) == WAIT_TIMEOUT);
+    if( timed_out )
+    {
+        TerminateProcess(pi.hProcess, 1);
+        WaitForSingleObject(pi.hProcess, INFINITE);
+    }
+    {
+        PROCESS_MEMORY_COUNTERS pmc = { 0 };
+        pmc.cb = sizeof(pmc);
+        GetProcessMemoryInfo(pi.hProcess, &pmc, sizeof(pmc));
+        set_stats(pmc.PeakWorkingSetSize / 1024);
+    }
+    if( timed_out )
+    {
+        DEBUG(exe_name << " timed out after " << timeout << " seconds, see log " << outfile);
+        return false;
+    }
     DWORD status = 1;
     GetExitCodeProcess(pi.hProcess, &status);
     if (status != 0)
@@ -525,20 +834,61 @@ bool run_executable(const ::helpers::path& exe_name, const ::std::vector<const c
         posix_spawn_file_actions_adddup2(&file_actions, 1, 2);
     }
 
+    // With a timeout, run in a new process group so a timeout also kills anything it started (e.g. the C compiler)
+    // - Otherwise stay in our group, so a terminal interrupt (Ctrl-C) still reaches the child
+    posix_spawnattr_t   attrs;
+    posix_spawnattr_init(&attrs);
+    if( timeout > 0 )
+    {
+        posix_spawnattr_setflags(&attrs, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attrs, 0);
+    }
+
     auto argv = args;
     argv.push_back(nullptr);
     pid_t   pid;
-    int rv = posix_spawn(&pid, exe_name.str().c_str(), &file_actions, nullptr, const_cast<char**>(argv.data()), environ);
+    int rv = posix_spawn(&pid, exe_name.str().c_str(), &file_actions, &attrs, const_cast<char**>(argv.data()), environ);
+    posix_spawnattr_destroy(&attrs);
+    posix_spawn_file_actions_destroy(&file_actions);
     if( rv != 0 )
     {
         DEBUG("Error in posix_spawn - " << rv);
         return false;
     }
 
-    posix_spawn_file_actions_destroy(&file_actions);
-
+    // NOTE: `wait4` is used to get the child's peak memory usage
     int status = -1;
-    waitpid(pid, &status, 0);
+    struct rusage   ru;
+    auto get_peak_kb = [&]()->uint64_t {
+#ifdef __APPLE__
+        return ru.ru_maxrss / 1024; // Bytes on macOS
+#else
+        return ru.ru_maxrss;
+#endif
+        };
+    if( timeout > 0 )
+    {
+        auto deadline = ::std::chrono::steady_clock::now() + ::std::chrono::seconds(timeout);
+        ::std::chrono::milliseconds poll_delay { 1 };
+        while( wait4(pid, &status, WNOHANG, &ru) == 0 )
+        {
+            if( ::std::chrono::steady_clock::now() >= deadline )
+            {
+                kill(-pid, SIGKILL);
+                wait4(pid, &status, 0, &ru);
+                set_stats(get_peak_kb());
+                DEBUG(exe_name << " timed out after " << timeout << " seconds, see log " << outfile_str);
+                return false;
+            }
+            ::std::this_thread::sleep_for(poll_delay);
+            poll_delay = ::std::min(poll_delay * 2, ::std::chrono::milliseconds(100));
+        }
+    }
+    else
+    {
+        wait4(pid, &status, 0, &ru);
+    }
+    set_stats(get_peak_kb());
     if( status != 0 )
     {
         if( WIFEXITED(status) )
@@ -553,6 +903,35 @@ bool run_executable(const ::helpers::path& exe_name, const ::std::vector<const c
     return true;
 }
 
+// File format: One line per test - `<name> <compile seconds> <compile peak KiB> <run seconds> <run peak KiB>`
+void TimingHistory::load(const ::helpers::path& p)
+{
+    ::std::ifstream in(p.str());
+    ::std::string   line;
+    while( ::std::getline(in, line) )
+    {
+        if( line.empty() || line[0] == '#' )
+            continue ;
+        ::std::istringstream    ss(line);
+        ::std::string   name;
+        TestTimes   t;
+        if( ss >> name >> t.compile.time >> t.compile.peak_memory_kb >> t.run.time >> t.run.peak_memory_kb )
+        {
+            m_times[name] = t;
+        }
+    }
+}
+void TimingHistory::save(const ::helpers::path& p) const
+{
+    ::std::ofstream out(p.str());
+    out << "# name compile_seconds compile_peak_kib run_seconds run_peak_kib\n";
+    for(const auto& e : m_times)
+    {
+        const auto& t = e.second;
+        out << e.first << " " << t.compile.time << " " << t.compile.peak_memory_kb << " " << t.run.time << " " << t.run.peak_memory_kb << "\n";
+    }
+}
+
 Timestamp Timestamp::for_file(const ::helpers::path& path)
 {
 #if _WIN32
@@ -584,27 +963,31 @@ Timestamp Timestamp::for_file(const ::helpers::path& path)
 }
 
 
-static int giIndentLevel = 0;
+// Per-thread, as tests are run on worker threads
+static thread_local int giIndentLevel = 0;
 void Debug_Print(::std::function<void(::std::ostream& os)> cb)
 {
+    auto& os = debug_output_stream();
     for(auto i = giIndentLevel; i --; )
-        ::std::cout << " ";
-    cb(::std::cout);
-    ::std::cout << ::std::endl;
+        os << " ";
+    cb(os);
+    os << ::std::endl;
 }
 void Debug_EnterScope(const char* name, dbg_cb_t cb)
 {
+    auto& os = debug_output_stream();
     for(auto i = giIndentLevel; i --; )
-        ::std::cout << " ";
-    ::std::cout << ">>> " << name << "(";
-    cb(::std::cout);
-    ::std::cout << ")" << ::std::endl;
+        os << " ";
+    os << ">>> " << name << "(";
+    cb(os);
+    os << ")" << ::std::endl;
     giIndentLevel ++;
 }
 void Debug_LeaveScope(const char* name, dbg_cb_t cb)
 {
+    auto& os = debug_output_stream();
     giIndentLevel --;
     for(auto i = giIndentLevel; i --; )
-        ::std::cout << " ";
-    ::std::cout << "<<< " << name << ::std::endl;
+        os << " ";
+    os << "<<< " << name << ::std::endl;
 }